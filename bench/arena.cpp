@@ -0,0 +1,104 @@
+// A request handler parsing a document of about 10000 nodes and dropping it:
+// values of standard_properties against arena_properties with the arena
+// released after each request, for time and for heap allocations.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/arena.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::size_t allocations = 0;
+
+std::string make_document()
+{
+    std::ostringstream out;
+    out << "{\"user\": \"someone\", \"tracks\": [";
+    for (int i = 0; i < 1000; ++i)
+    {
+        out << (i ? "," : "") << "{\"artist\": \"Some Artist " << i % 37
+            << "\", \"track\": \"A Track With A Longer Name " << i << "\", \"timestamp\": " << 1500000000 + i
+            << ", \"duration\": " << 180 + i % 60 << ", \"tags\": [\"rock\", \"indie\"], \"loved\": "
+            << (i % 2 ? "true" : "false") << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+struct standard_request
+{
+    std::string const & json;
+    std::size_t size;
+
+    void operator()()
+    {
+        lastjson::value const v = lastjson::parse(json);
+        size += v["tracks"].get_array().size();
+    }
+};
+
+struct arena_request
+{
+    std::string const & json;
+    lastjson::arena & memory;
+    std::size_t size;
+
+    void operator()()
+    {
+        {
+            lastjson::arena_scope scope(memory);
+            lastjson::arena_value const v = lastjson::parse<lastjson::arena_value>(json);
+            size += v["tracks"].get_array().size();
+        }
+        memory.release();
+    }
+};
+
+template<class F>
+void report_allocations(char const * name, F & f)
+{
+    f(); // reach the steady state
+    std::size_t const before = allocations;
+    f();
+    std::printf("%-40s %12zu allocations/document\n", name, allocations - before);
+}
+
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    if (void * p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw()
+{
+    std::free(p);
+}
+
+int main()
+{
+    std::string const json = make_document();
+
+    lastjson::arena memory;
+    standard_request s = { json, 0 };
+    bench::run("standard_properties", s, json.size());
+    arena_request a = { json, memory, 0 };
+    bench::run("arena_properties", a, json.size());
+
+    report_allocations("standard_properties", s);
+    report_allocations("arena_properties", a);
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef LASTJSON_BENCH_HPP__
+#define LASTJSON_BENCH_HPP__
+
+#include <cstdio>
+#include <cstddef>
+#include <sys/time.h>
+
+namespace bench {
+
+inline double now()
+{
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/**
+ * \brief Runs f repeatedly for about half a second and reports the time per run
+ *
+ * \param name Label printed in the report
+ * \param f Functor to benchmark
+ * \param bytes Bytes processed per run, for throughput reporting (0 for none)
+ * \return Seconds per run
+ */
+template<class F>
+inline double run(char const * name, F f, std::size_t bytes = 0)
+{
+    f(); // warm up
+
+    std::size_t iterations = 0;
+    double const start = now();
+    double elapsed = 0;
+    do
+    {
+        f();
+        ++iterations;
+        elapsed = now() - start;
+    }
+    while (elapsed < 0.5);
+
+    double const per_run = elapsed / iterations;
+    if (bytes)
+    {
+        std::printf("%-40s %12.3f ms/run %10.1f MB/s\n", name, per_run * 1e3, bytes / per_run / 1e6);
+    }
+    else
+    {
+        std::printf("%-40s %12.3f ms/run\n", name, per_run * 1e3);
+    }
+
+    return per_run;
+}
+
+} // namespace bench
+
+#endif // ifndef LASTJSON_BENCH_HPP__
@@ -0,0 +1,190 @@
+// Request documents read into plain structs: parse() into a value and
+// copying the fields out against parse_struct() with a binding, and
+// writing the structs out through a value against write_json().
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lastjson/binding.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+struct scrobble
+{
+    std::string artist;
+    std::string track;
+    lastjson::int64_t timestamp;
+    int duration;
+    bool chosen_by_user;
+};
+
+struct request
+{
+    std::string method;
+    std::string user;
+    std::string session;
+    std::vector<scrobble> tracks;
+};
+
+}
+
+LASTJSON_BIND_BEGIN(scrobble)
+    LASTJSON_BIND_FIELD(artist)
+    LASTJSON_BIND_FIELD(track)
+    LASTJSON_BIND_FIELD(timestamp)
+    LASTJSON_BIND_FIELD(duration)
+    LASTJSON_BIND_FIELD(chosen_by_user)
+LASTJSON_BIND_END()
+
+LASTJSON_BIND_BEGIN(request)
+    LASTJSON_BIND_FIELD(method)
+    LASTJSON_BIND_FIELD(user)
+    LASTJSON_BIND_FIELD(session)
+    LASTJSON_BIND_FIELD(tracks)
+LASTJSON_BIND_END()
+
+namespace {
+
+std::vector<std::string> make_requests()
+{
+    std::vector<std::string> requests;
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::ostringstream out;
+        out << "{\"method\": \"track.scrobble\", \"user\": \"user" << i % 97
+            << "\", \"session\": \"0123456789abcdef0123456789abcdef\", \"tracks\": [";
+        for (int t = 0; t < 5 + i % 3; ++t)
+        {
+            out << (t ? "," : "") << "{\"artist\": \"Some Artist " << t
+                << "\", \"track\": \"Track " << i << "\", \"timestamp\": " << 1500000000 + i * 10 + t
+                << ", \"duration\": " << 180 + t << ", \"chosen_by_user\": " << (t % 2 ? "true" : "false") << "}";
+        }
+        out << "], \"api_key\": \"abcdef0123456789abcdef0123456789\"}";
+        requests.push_back(out.str());
+    }
+    return requests;
+}
+
+void from_value(lastjson::value const & v, request & r)
+{
+    r.method = v["method"].get_string();
+    r.user = v["user"].get_string();
+    r.session = v["session"].get_string();
+    lastjson::value::array_type const & tracks = v["tracks"].get_array();
+    r.tracks.resize(tracks.size());
+    for (std::size_t i = 0; i < tracks.size(); ++i)
+    {
+        r.tracks[i].artist = tracks[i]["artist"].get_string();
+        r.tracks[i].track = tracks[i]["track"].get_string();
+        r.tracks[i].timestamp = tracks[i]["timestamp"].get_int();
+        r.tracks[i].duration = tracks[i]["duration"].get_int();
+        r.tracks[i].chosen_by_user = tracks[i]["chosen_by_user"].get_bool();
+    }
+}
+
+lastjson::value to_value(request const & r)
+{
+    lastjson::value::object_type object;
+    object["method"] = r.method;
+    object["user"] = r.user;
+    object["session"] = r.session;
+    lastjson::value::array_type tracks;
+    for (std::size_t i = 0; i < r.tracks.size(); ++i)
+    {
+        lastjson::value::object_type track;
+        track["artist"] = r.tracks[i].artist;
+        track["track"] = r.tracks[i].track;
+        track["timestamp"] = r.tracks[i].timestamp;
+        track["duration"] = r.tracks[i].duration;
+        track["chosen_by_user"] = r.tracks[i].chosen_by_user;
+        tracks.push_back(track);
+    }
+    object["tracks"] = tracks;
+    return object;
+}
+
+struct via_value
+{
+    std::vector<std::string> const & requests;
+    request r;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            from_value(lastjson::parse(requests[i]), r);
+        }
+    }
+};
+
+struct via_binding
+{
+    std::vector<std::string> const & requests;
+    request r;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            lastjson::parse_struct(requests[i], r);
+        }
+    }
+};
+
+struct write_via_value
+{
+    std::vector<request> const & requests;
+    std::size_t size;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            size += lastjson::stringify(to_value(requests[i])).size();
+        }
+    }
+};
+
+struct write_via_binding
+{
+    std::vector<request> const & requests;
+    std::size_t size;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            size += lastjson::stringify(requests[i]).size();
+        }
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::vector<std::string> const json = make_requests();
+    std::size_t bytes = 0;
+    std::vector<request> requests(json.size());
+    for (std::size_t i = 0; i < json.size(); ++i)
+    {
+        bytes += json[i].size();
+        lastjson::parse_struct(json[i], requests[i]);
+    }
+
+    via_value v = { json, request() };
+    bench::run("parse() and copy fields", v, bytes);
+    via_binding b = { json, request() };
+    bench::run("parse_struct()", b, bytes);
+
+    write_via_value wv = { requests, 0 };
+    bench::run("stringify() through a value", wv);
+    write_via_binding wb = { requests, 0 };
+    bench::run("stringify() with a binding", wb);
+
+    return 0;
+}
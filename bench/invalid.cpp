@@ -0,0 +1,90 @@
+// Rejecting untrusted input: half of a batch of small documents is invalid.
+// Parsing with parse() and catching parser_error against try_parse().
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lastjson/parse.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::vector<std::string> make_batch(std::size_t & bytes)
+{
+    char const * const damage[] = { "}", "\"", ",", "x", "[" };
+
+    std::vector<std::string> batch;
+    bytes = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::ostringstream out;
+        out << "{\"id\": " << i << ", \"name\": \"item " << i
+            << "\", \"tags\": [\"a\", \"b\"], \"price\": " << 9.5 + i % 100 << "}";
+        std::string doc = out.str();
+        if (i % 2)
+        {
+            // break the document somewhere in its second half
+            doc.insert(doc.size() / 2 + i % (doc.size() / 2), damage[i % 5]);
+        }
+
+        bytes += doc.size();
+        batch.push_back(doc);
+    }
+    return batch;
+}
+
+struct with_exceptions
+{
+    std::vector<std::string> const & batch;
+    std::size_t rejected;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            try
+            {
+                lastjson::parse(batch[i]);
+            }
+            catch (lastjson::parser_error const &)
+            {
+                ++rejected;
+            }
+        }
+    }
+};
+
+struct with_result
+{
+    std::vector<std::string> const & batch;
+    std::size_t rejected;
+
+    void operator()()
+    {
+        lastjson::value v;
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            if (!lastjson::try_parse(batch[i], v).ok())
+            {
+                ++rejected;
+            }
+        }
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::size_t bytes;
+    std::vector<std::string> const batch = make_batch(bytes);
+
+    with_exceptions exceptions = { batch, 0 };
+    bench::run("parse() catching parser_error", exceptions, bytes);
+    with_result result = { batch, 0 };
+    bench::run("try_parse()", result, bytes);
+
+    return 0;
+}
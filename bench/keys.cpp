@@ -0,0 +1,75 @@
+// Record-oriented data repeating the same keys: std::string keys against
+// interned keys, for parse time and for the heap held by the result.
+
+#include <malloc.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/interned_key.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_records()
+{
+    std::ostringstream out;
+    out << '[';
+    for (int i = 0; i < 20000; ++i)
+    {
+        out << (i ? "," : "") << "{\"timestamp\": " << 1500000000 + i
+            << ", \"user\": \"u" << i % 977 << "\", \"artist_name\": \"a\", \"track_name\": \"t\""
+            << ", \"album_name\": \"b\", \"duration\": 180, \"scrobble_source\": \"p\""
+            << ", \"user_agent_string\": \"x\", \"client_application_id\": 3"
+            << ", \"is_loved\": false, \"is_skipped\": false, \"country_code\": \"GB\""
+            << ", \"listening_session_identifier\": " << i / 10
+            << ", \"track_position_in_session\": " << i % 10
+            << ", \"recommendation_source\": null, \"a\": 1, \"b\": 2, \"c\": 3, \"d\": 4, \"e\": 5}";
+    }
+    out << ']';
+    return out.str();
+}
+
+std::size_t heap_in_use()
+{
+    return mallinfo2().uordblks;
+}
+
+template<class Value>
+struct parse_records
+{
+    std::string const & json;
+
+    void operator()()
+    {
+        lastjson::parse<Value>(json);
+    }
+};
+
+template<class Value>
+void report_heap(char const * name, std::string const & json)
+{
+    std::size_t const before = heap_in_use();
+    Value v = lastjson::parse<Value>(json);
+    std::printf("%-40s %12.1f MB held\n", name, (heap_in_use() - before) / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+    std::string const json = make_records();
+
+    parse_records<lastjson::value> plain = { json };
+    bench::run("std::string keys", plain, json.size());
+    parse_records<lastjson::interned_value> interned = { json };
+    bench::run("interned keys", interned, json.size());
+
+    report_heap<lastjson::value>("std::string keys", json);
+    report_heap<lastjson::interned_value>("interned keys", json);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Proxying: read the envelope of a message and write the message out again,
+// with the payload parsed fully or deferred by parse_lazy.
+
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/lazy_parse.hpp>
+#include <lastjson/stringify.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_message()
+{
+    std::ostringstream out;
+    out << "{\"id\": 12345, \"route\": \"scrobble\", \"payload\": [";
+    for (int i = 0; i < 20000; ++i)
+    {
+        out << (i ? "," : "") << "{\"artist\": \"Some Artist\", \"title\": \"Track " << i
+            << "\", \"duration\": " << 180.5 + i % 60 << ", \"tags\": [\"rock\", \"indie\"]}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+struct proxy_parsed
+{
+    std::string const & message;
+    std::size_t bytes;
+
+    void operator()()
+    {
+        lastjson::value v = lastjson::parse(message);
+        bytes += v["route"].get_string().size();
+        bytes += lastjson::stringify(v).size();
+    }
+};
+
+struct proxy_lazy
+{
+    std::string const & message;
+    std::size_t bytes;
+
+    void operator()()
+    {
+        lastjson::value v = lastjson::parse_lazy(message);
+        bytes += v["route"].get_string().size();
+        bytes += lastjson::stringify(v).size();
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::string const message = make_message();
+
+    proxy_parsed parsed = { message, 0 };
+    bench::run("parse() + stringify()", parsed, message.size());
+    proxy_lazy lazy = { message, 0 };
+    bench::run("parse_lazy() + stringify()", lazy, message.size());
+
+    return 0;
+}
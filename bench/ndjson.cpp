@@ -0,0 +1,113 @@
+// Newline-delimited JSON: parsing line by line on one thread against the
+// ndjson_parser with a growing number of worker threads.
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/ndjson.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_log()
+{
+    std::ostringstream out;
+    for (int i = 0; i < 50000; ++i)
+    {
+        out << "{\"ts\": " << 1500000000000LL + i << ", \"user\": \"user" << i % 977
+            << "\", \"track\": {\"artist\": \"Some Artist\", \"title\": \"Track " << i
+            << "\", \"duration\": " << 180.5 + i % 60 << "}, \"tags\": [\"rock\", \"indie\"]}\n";
+    }
+    return out.str();
+}
+
+struct line_by_line
+{
+    std::string const & log;
+    std::size_t records;
+
+    void operator()()
+    {
+        char const * it = log.data();
+        char const * const end = it + log.size();
+        while (it != end)
+        {
+            char const * nl = static_cast<char const *>(std::memchr(it, '\n', end - it));
+            lastjson::parse(it, nl ? nl : end);
+            ++records;
+            it = nl ? nl + 1 : end;
+        }
+    }
+};
+
+struct line_by_line_kept
+{
+    std::string const & log;
+    std::vector<lastjson::value> values;
+
+    void operator()()
+    {
+        values.clear();
+        char const * it = log.data();
+        char const * const end = it + log.size();
+        while (it != end)
+        {
+            char const * nl = static_cast<char const *>(std::memchr(it, '\n', end - it));
+            values.push_back(lastjson::parse(it, nl ? nl : end));
+            it = nl ? nl + 1 : end;
+        }
+    }
+};
+
+struct count_records
+{
+    std::size_t records;
+
+    void operator()(lastjson::ndjson_record &)
+    {
+        ++records;
+    }
+};
+
+struct pooled
+{
+    std::string const & log;
+    lastjson::ndjson_parser & parser;
+    count_records counter;
+
+    void operator()()
+    {
+        parser.parse(log.data(), log.data() + log.size(), counter);
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::string const log = make_log();
+
+    line_by_line single = { log, 0 };
+    bench::run("parse() per line", single, log.size());
+    line_by_line_kept kept = { log, std::vector<lastjson::value>() };
+    bench::run("parse() per line, values kept", kept, log.size());
+
+    std::size_t const max_threads = lastjson::impl::default_thread_count();
+    for (std::size_t threads = 1; threads <= 2 * max_threads; threads *= 2)
+    {
+        lastjson::ndjson_options options;
+        options.threads = threads;
+        lastjson::ndjson_parser parser(options);
+        pooled p = { log, parser, count_records() };
+        char name[64];
+        std::snprintf(name, sizeof(name), "ndjson_parser, %u threads", unsigned(threads));
+        bench::run(name, p, log.size());
+    }
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Parsing deeply nested and wide documents, with both parser engines and
+// with and without building a value.
+
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/sax.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_deep()
+{
+    // many arrays nested 500 levels deep
+    std::string const one = std::string(500, '[') + "1" + std::string(500, ']');
+    std::string json = "[";
+    for (int i = 0; i < 200; ++i)
+    {
+        json += i ? "," + one : one;
+    }
+    return json + "]";
+}
+
+std::string make_wide()
+{
+    std::string json = "[";
+    for (int i = 0; i < 20000; ++i)
+    {
+        json += i ? "," : "";
+        json += "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}";
+    }
+    return json + "]";
+}
+
+struct count_handler : lastjson::sax_handler
+{
+    std::size_t events;
+
+    void on_int(int_type) { ++events; }
+    void on_start_array() { ++events; }
+    void on_start_object() { ++events; }
+};
+
+struct sax_scalar
+{
+    std::string const & json;
+    count_handler handler;
+
+    void operator()()
+    {
+        char const * it = json.data();
+        lastjson::impl::event_parser<count_handler>(handler).parse_value(it, it + json.size());
+    }
+};
+
+struct sax_indexed
+{
+    std::string const & json;
+    count_handler handler;
+
+    void operator()()
+    {
+        lastjson::impl::parse_indexed(json.data(), json.data() + json.size(), handler);
+    }
+};
+
+struct parse_document
+{
+    std::string const & json;
+    std::size_t size;
+
+    void operator()()
+    {
+        size += lastjson::parse(json).get_array().size();
+    }
+};
+
+void run_all(char const * what, std::string const & json)
+{
+    std::string name;
+    sax_scalar scalar = { json, count_handler() };
+    bench::run((name = what + std::string(": events, scalar")).c_str(), scalar, json.size());
+    sax_indexed indexed = { json, count_handler() };
+    bench::run((name = what + std::string(": events, indexed")).c_str(), indexed, json.size());
+    parse_document doc = { json, 0 };
+    bench::run((name = what + std::string(": parse")).c_str(), doc, json.size());
+}
+
+} // namespace
+
+int main()
+{
+    run_all("deep", make_deep());
+    run_all("wide", make_wide());
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Number parsing: the in-house parser of numparse.hpp against the former
+// std::string copy plus boost::lexical_cast, and parsing plus writing out a
+// document of numbers with and without parse_options::raw_numbers.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/stringify.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::vector<std::string> make_numbers()
+{
+    std::vector<std::string> numbers;
+    std::srand(1);
+    char buffer[64];
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        switch (i % 4)
+        {
+        case 0: // counters
+            std::snprintf(buffer, sizeof(buffer), "%d", std::rand());
+            break;
+        case 1: // timestamps in milliseconds
+            std::snprintf(buffer, sizeof(buffer), "%lld", 1500000000000LL + std::rand());
+            break;
+        case 2: // short measurements
+            std::snprintf(buffer, sizeof(buffer), "%.3f", std::rand() / 1000.0);
+            break;
+        default: // full precision doubles
+            std::snprintf(buffer, sizeof(buffer), "%.17g", std::rand() / double(RAND_MAX) * 1e6);
+            break;
+        }
+
+        numbers.push_back(buffer);
+    }
+
+    return numbers;
+}
+
+bool is_float(std::string const & s)
+{
+    return s.find_first_of(".eE") != std::string::npos;
+}
+
+struct lexical_cast_numbers
+{
+    std::vector<std::string> const & numbers;
+    double sum;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < numbers.size(); ++i)
+        {
+            std::string::const_iterator const begin = numbers[i].begin();
+            if (is_float(numbers[i]))
+            {
+                sum += boost::lexical_cast<double>(std::string(begin, numbers[i].end()));
+            }
+            else
+            {
+                sum += boost::lexical_cast<lastjson::int64_t>(std::string(begin, numbers[i].end()));
+            }
+        }
+    }
+};
+
+struct sum_handler : lastjson::sax_handler
+{
+    double sum;
+
+    void on_int(int_type i)
+    {
+        sum += i;
+    }
+
+    void on_float(float_type f)
+    {
+        sum += f;
+    }
+};
+
+struct numparse_numbers
+{
+    std::vector<std::string> const & numbers;
+    sum_handler handler;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < numbers.size(); ++i)
+        {
+            char const * it = numbers[i].data();
+            lastjson::impl::parse_number(it, it + numbers[i].size(), handler);
+        }
+    }
+};
+
+struct parse_document
+{
+    std::string const & json;
+    std::size_t size;
+
+    void operator()()
+    {
+        size += lastjson::parse(json).get_array().size();
+    }
+};
+
+struct roundtrip_document
+{
+    std::string const & json;
+    lastjson::parse_options options;
+    std::size_t size;
+
+    void operator()()
+    {
+        size += lastjson::stringify(lastjson::parse(json, options)).size();
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::vector<std::string> const numbers = make_numbers();
+
+    lexical_cast_numbers old_way = { numbers, 0 };
+    numparse_numbers new_way = { numbers, sum_handler() };
+    double const t_old = bench::run("boost::lexical_cast", old_way);
+    double const t_new = bench::run("impl::parse_number", new_way);
+    std::printf("speedup: %.1fx (%.1f ns vs %.1f ns per number)\n\n",
+                t_old / t_new, t_old / numbers.size() * 1e9, t_new / numbers.size() * 1e9);
+
+    std::string json = "[";
+    for (std::size_t i = 0; i < numbers.size(); ++i)
+    {
+        json += i ? "," + numbers[i] : numbers[i];
+    }
+    json += "]";
+
+    parse_document doc = { json, 0 };
+    bench::run("parse numeric array", doc, json.size());
+
+    roundtrip_document formatted = { json, lastjson::parse_options(), 0 };
+    roundtrip_document raw = { json, lastjson::parse_options(), 0 };
+    raw.options.raw_numbers = true;
+    bench::run("parse and stringify", formatted, json.size());
+    bench::run("parse and stringify, raw_numbers", raw, json.size());
+    std::printf("output is %s\n", lastjson::stringify(lastjson::parse(json, raw.options)) == json
+                ? "identical to the input" : "different from the input");
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+// One large top-level array: the serial parser against parse_parallel with a
+// growing number of threads.
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/parallel_parse.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_array()
+{
+    std::ostringstream out;
+    out << '[';
+    for (int i = 0; i < 200000; ++i)
+    {
+        out << (i ? "," : "") << "{\"ts\": " << 1500000000000LL + i << ", \"user\": \"user" << i % 977
+            << "\", \"track\": {\"artist\": \"Some Artist\", \"title\": \"Track " << i
+            << "\", \"duration\": " << 180.5 + i % 60 << "}, \"tags\": [\"rock\", \"indie\"]}";
+    }
+    out << ']';
+    return out.str();
+}
+
+struct serial
+{
+    std::string const & json;
+
+    void operator()()
+    {
+        lastjson::parse(json);
+    }
+};
+
+struct parallel
+{
+    std::string const & json;
+    lastjson::parallel_options options;
+
+    void operator()()
+    {
+        lastjson::parse_parallel(json, options);
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::string const json = make_array();
+
+    serial s = { json };
+    bench::run("parse()", s, json.size());
+
+    std::size_t const max_threads = lastjson::impl::default_thread_count();
+    for (std::size_t threads = 1; threads <= 2 * max_threads; threads *= 2)
+    {
+        parallel p = { json, lastjson::parallel_options() };
+        p.options.threads = threads;
+        char name[64];
+        std::snprintf(name, sizeof(name), "parse_parallel(), %u threads", unsigned(threads));
+        bench::run(name, p, json.size());
+    }
+
+    return 0;
+}
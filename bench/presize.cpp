@@ -0,0 +1,113 @@
+// Large arrays of objects, parsed with arrays growing element by element
+// against arrays reserved up front from counts taken from the structural
+// index (parse_options::presize_arrays), for time and for heap allocations
+// and bytes allocated per document.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::size_t allocations = 0;
+std::size_t allocated_bytes = 0;
+
+std::string make_tracks(int count)
+{
+    std::ostringstream out;
+    out << "{\"recenttracks\": {\"user\": \"someone\", \"track\": [";
+    for (int i = 0; i < count; ++i)
+    {
+        out << (i ? "," : "") << "{\"artist\": \"Artist " << i % 1000 << "\", \"name\": \"Track " << i
+            << "\", \"date\": " << 1500000000 + i << ", \"tags\": [" << i % 7 << ", " << i % 11 << "]}";
+    }
+    out << "]}}";
+    return out.str();
+}
+
+std::string make_series(int rows, int columns)
+{
+    std::ostringstream out;
+    out << "[";
+    for (int i = 0; i < rows; ++i)
+    {
+        out << (i ? "," : "") << "{\"id\": " << i << ", \"values\": [";
+        for (int j = 0; j < columns; ++j)
+        {
+            out << (j ? "," : "") << (i * j) % 1000;
+        }
+        out << "]}";
+    }
+    out << "]";
+    return out.str();
+}
+
+struct parse_with
+{
+    std::string const & json;
+    lastjson::parse_options options;
+
+    void operator()()
+    {
+        lastjson::value v = lastjson::parse(json, options);
+    }
+};
+
+void report_allocations(char const * name, parse_with f)
+{
+    std::size_t const before = allocations;
+    std::size_t const before_bytes = allocated_bytes;
+    f();
+    std::printf("%-40s %12lu allocations %12.1f MB allocated\n", name,
+                (unsigned long)(allocations - before), (allocated_bytes - before_bytes) / 1e6);
+}
+
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    allocated_bytes += size;
+    if (void * p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw()
+{
+    std::free(p);
+}
+
+int main()
+{
+    std::string const tracks = make_tracks(20000);
+    std::string const series = make_series(2000, 100);
+
+    lastjson::parse_options presize;
+    presize.presize_arrays = true;
+
+    parse_with tracks_growing = { tracks, lastjson::parse_options() };
+    parse_with tracks_reserved = { tracks, presize };
+    parse_with series_growing = { series, lastjson::parse_options() };
+    parse_with series_reserved = { series, presize };
+
+    bench::run("tracks, arrays growing", tracks_growing, tracks.size());
+    bench::run("tracks, arrays reserved", tracks_reserved, tracks.size());
+    bench::run("series, arrays growing", series_growing, series.size());
+    bench::run("series, arrays reserved", series_reserved, series.size());
+
+    report_allocations("tracks, arrays growing", tracks_growing);
+    report_allocations("tracks, arrays reserved", tracks_reserved);
+    report_allocations("series, arrays growing", series_growing);
+    report_allocations("series, arrays reserved", series_reserved);
+
+    return 0;
+}
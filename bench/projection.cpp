@@ -0,0 +1,84 @@
+// Extracting a few fields from each document: a full parse() against
+// parse_projected() with a projection compiled once.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/projection.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_document(int n)
+{
+    std::ostringstream out;
+    out << "{\"user\": {\"id\": " << n << ", \"name\": \"user" << n
+        << "\", \"country\": \"GB\", \"subscriber\": true}, \"items\": [";
+    for (int i = 0; i < 20; ++i)
+    {
+        out << (i ? "," : "") << "{\"sku\": \"sku-" << i << "\", \"price\": " << 0.99 + i
+            << ", \"title\": \"Some Track Title " << i << "\", \"artists\": [\"A\", \"B\"]"
+            << ", \"meta\": {\"bitrate\": 320, \"codec\": \"mp3\", \"tags\": [\"rock\", \"indie\"]}}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+struct full
+{
+    std::vector<std::string> const & docs;
+    double sum;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < docs.size(); ++i)
+        {
+            lastjson::value v = lastjson::parse(docs[i]);
+            sum += v["user"]["id"].get_float() + v["items"][0]["price"].get_float();
+        }
+    }
+};
+
+struct projected
+{
+    std::vector<std::string> const & docs;
+    lastjson::projection const & paths;
+    double sum;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < docs.size(); ++i)
+        {
+            lastjson::value v = lastjson::parse_projected(docs[i], paths);
+            sum += v["user"]["id"].get_float() + v["items"][0]["price"].get_float();
+        }
+    }
+};
+
+} // namespace
+
+int main()
+{
+    std::vector<std::string> docs;
+    std::size_t bytes = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        docs.push_back(make_document(i));
+        bytes += docs.back().size();
+    }
+
+    std::vector<std::string> pointers;
+    pointers.push_back("/user/id");
+    pointers.push_back("/items/*/price");
+    lastjson::projection const paths(pointers);
+
+    full f = { docs, 0 };
+    bench::run("parse()", f, bytes);
+    projected p = { docs, paths, 0 };
+    bench::run("parse_projected()", p, bytes);
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// A request loop parsing documents of the same shape over and over:
+// parse() building a new value each time against parse_into() reusing the
+// previous one, for time and for heap allocations per document.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lastjson/parse.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::size_t allocations = 0;
+
+std::vector<std::string> make_requests()
+{
+    std::vector<std::string> requests;
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::ostringstream out;
+        out << "{\"method\": \"track.scrobble\", \"user\": \"user" << i % 97
+            << "\", \"session\": \"0123456789abcdef0123456789abcdef\", \"tracks\": [";
+        for (int t = 0; t < 5 + i % 3; ++t)
+        {
+            out << (t ? "," : "") << "{\"artist\": \"Some Artist " << t
+                << "\", \"track\": \"Track " << i << "\", \"timestamp\": " << 1500000000 + i * 10 + t
+                << ", \"duration\": " << 180 + t << ", \"chosen_by_user\": " << (t % 2 ? "true" : "false") << "}";
+        }
+        out << "], \"api_key\": \"abcdef0123456789abcdef0123456789\"}";
+        requests.push_back(out.str());
+    }
+    return requests;
+}
+
+struct fresh
+{
+    std::vector<std::string> const & requests;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            lastjson::value v = lastjson::parse(requests[i]);
+        }
+    }
+};
+
+struct reused
+{
+    std::vector<std::string> const & requests;
+    lastjson::value v;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < requests.size(); ++i)
+        {
+            lastjson::parse_into(requests[i], v);
+        }
+    }
+};
+
+template<class F>
+void report_allocations(char const * name, F f, std::size_t documents)
+{
+    f(); // reach the steady state
+    std::size_t const before = allocations;
+    f();
+    std::printf("%-40s %12.1f allocations/document\n", name, double(allocations - before) / documents);
+}
+
+} // namespace
+
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    if (void * p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) throw()
+{
+    std::free(p);
+}
+
+int main()
+{
+    std::vector<std::string> const requests = make_requests();
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < requests.size(); ++i)
+    {
+        bytes += requests[i].size();
+    }
+
+    fresh f = { requests };
+    bench::run("parse()", f, bytes);
+    reused r = { requests, lastjson::value() };
+    bench::run("parse_into()", r, bytes);
+
+    report_allocations("parse()", f, requests.size());
+    report_allocations("parse_into()", r, requests.size());
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+// String-heavy documents: parse() copying every string into a value of its
+// own, against parse_shared() referencing the strings in the input buffer,
+// and the cost of validating UTF-8 while parsing.
+
+#include <sstream>
+#include <string>
+
+#include <lastjson/parse.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+std::string make_catalogue()
+{
+    std::ostringstream out;
+    out << '[';
+    for (int i = 0; i < 50000; ++i)
+    {
+        out << (i ? "," : "") << "{\"artist\": \"Some Artist " << i % 331 << (i % 3 ? "" : " S\xc3\xb8ren")
+            << "\", \"title\": \"A Somewhat Longer Track Title " << i
+            << "\", \"album\": \"Album\", \"url\": \"https://www.last.fm/music/Some+Artist/_/Track+" << i
+            << "\", \"tags\": [\"rock\", \"indie\", \"alternative\"]}";
+    }
+    out << ']';
+    return out.str();
+}
+
+struct copied
+{
+    std::string const & json;
+
+    void operator()()
+    {
+        lastjson::parse(json);
+    }
+};
+
+struct validated
+{
+    std::string const & json;
+
+    void operator()()
+    {
+        lastjson::parse_options options;
+        options.validate_utf8 = true;
+        lastjson::parse(json, options);
+    }
+};
+
+struct shared
+{
+    lastjson::shared_ptr<std::string const> json;
+
+    void operator()()
+    {
+        lastjson::parse_shared(json);
+    }
+};
+
+} // namespace
+
+int main()
+{
+    lastjson::shared_ptr<std::string const> json(new std::string(make_catalogue()));
+
+    copied c = { *json };
+    bench::run("parse()", c, json->size());
+    validated v = { *json };
+    bench::run("parse(), validate_utf8", v, json->size());
+    shared s = { json };
+    bench::run("parse_shared()", s, json->size());
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Long string values: scanning for the closing quote a byte at a time
+// against impl::unescape_string and parse(), over text shaped like the
+// corpora in test/stringescape.cpp. Build with -mavx2 to scan 32 bytes at
+// a time instead of 16.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/stringrep.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+// three byte UTF-8 characters, like the random text of the escape tests
+std::string random_cjk(std::size_t characters)
+{
+    std::string out;
+    for (std::size_t i = 0; i < characters; ++i)
+    {
+        unsigned const cp = 0x4e00 + std::rand() % 0x5000;
+        out += char(0xe0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+    }
+    return out;
+}
+
+std::string lyrics(bool with_newlines)
+{
+    std::string out;
+    for (int line = 0; line < 40; ++line)
+    {
+        out += "And the song goes on and on, through the night until the morning light";
+        out += with_newlines ? "\n" : " ";
+    }
+    return out;
+}
+
+struct corpus
+{
+    char const * name;
+    std::vector<std::string> escaped;   // JSON strings, quotes included
+    std::string document;               // all of them in an array
+    std::size_t bytes;
+};
+
+corpus make_corpus(char const * name, std::string (*make)(int))
+{
+    corpus c = { name, std::vector<std::string>(), "[", 0 };
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::string const s = lastjson::escape_string(make(i), i % 2 == 0);
+        c.escaped.push_back(s);
+        c.document += (i ? "," : "") + s;
+        c.bytes += s.size();
+    }
+    c.document += "]";
+    return c;
+}
+
+std::string plain_text(int) { return lyrics(false); }
+std::string text_with_newlines(int) { return lyrics(true); }
+std::string cjk_text(int) { return random_cjk(400); }
+std::string mixed_text(int i) { return lyrics(i % 3 == 0) + random_cjk(50) + "\"quoted\""; }
+
+/**
+ * \brief The string scan as it was, testing every byte for quote and backslash
+ */
+void byte_at_a_time(char const * & it, char const * end, std::string & out)
+{
+    char const * run_begin = it;
+    while (it != end)
+    {
+        if (*it == '"')
+        {
+            out.append(run_begin, it);
+            ++it;
+            return;
+        }
+        else if (*it == '\\')
+        {
+            out.append(run_begin, it);
+            ++it;
+            std::back_insert_iterator<std::string> outit(out);
+            lastjson::impl::unescape_sequence(it, end, outit);
+            run_begin = it;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+struct scan_bytes
+{
+    corpus const & c;
+    std::string out;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < c.escaped.size(); ++i)
+        {
+            char const * it = c.escaped[i].data() + 1;
+            out.clear();
+            byte_at_a_time(it, c.escaped[i].data() + c.escaped[i].size(), out);
+        }
+    }
+};
+
+struct scan_vector
+{
+    corpus const & c;
+    std::string out;
+
+    void operator()()
+    {
+        for (std::size_t i = 0; i < c.escaped.size(); ++i)
+        {
+            char const * it = c.escaped[i].data() + 1;
+            out.clear();
+            lastjson::impl::unescape_string(it, c.escaped[i].data() + c.escaped[i].size(), out);
+        }
+    }
+};
+
+struct parse_document
+{
+    corpus const & c;
+
+    void operator()()
+    {
+        lastjson::parse(c.document);
+    }
+};
+
+} // namespace
+
+int main()
+{
+    corpus const corpora[] =
+    {
+        make_corpus("plain text", plain_text),
+        make_corpus("text with newlines", text_with_newlines),
+        make_corpus("cjk text", cjk_text),
+        make_corpus("mixed text", mixed_text),
+    };
+
+    for (std::size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]); ++i)
+    {
+        char name[64];
+        scan_bytes bytes = { corpora[i], std::string() };
+        std::snprintf(name, sizeof(name), "%s: byte at a time", corpora[i].name);
+        bench::run(name, bytes, corpora[i].bytes);
+
+        scan_vector vector = { corpora[i], std::string() };
+        std::snprintf(name, sizeof(name), "%s: unescape_string", corpora[i].name);
+        bench::run(name, vector, corpora[i].bytes);
+
+        parse_document doc = { corpora[i] };
+        std::snprintf(name, sizeof(name), "%s: parse()", corpora[i].name);
+        bench::run(name, doc, corpora[i].document.size());
+    }
+
+    return 0;
+}
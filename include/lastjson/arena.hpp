@@ -0,0 +1,642 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+
+#ifndef LASTJSON_ARENA_HPP__
+#define LASTJSON_ARENA_HPP__
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef LASTJSON_CXX11
+# include <type_traits>
+#else
+# include <boost/thread/tss.hpp>
+# include <boost/type_traits/alignment_of.hpp>
+#endif
+
+#include "value.hpp"
+#include "impl_helpers.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Bump allocator whose memory is freed all at once
+ *
+ * Memory is handed out from blocks obtained with operator new, by moving a
+ * pointer forward. Nothing is returned to the arena before release() or
+ * its destructor, which free the blocks in one go. Every value, string,
+ * array and object allocated from the arena must be destroyed by then.
+ *
+ * arena_value and the containers of arena_properties allocate from the
+ * arena that is current on the calling thread, see arena_scope. The arena
+ * itself may only be used by one thread at a time.
+ */
+class arena
+{
+public:
+    enum { default_block_size = 64 * 1024 };
+
+    explicit arena(std::size_t block_size = default_block_size)
+        : m_top(0)
+        , m_end(0)
+        , m_blocks(0)
+        , m_block_size(block_size < 1024 ? 1024 : block_size)
+        , m_capacity(0)
+    {
+    }
+
+    ~arena()
+    {
+        free_blocks(0);
+    }
+
+    /**
+     * \brief Allocate size bytes aligned to alignment, a power of two
+     */
+    void * allocate(std::size_t size, std::size_t alignment)
+    {
+        std::size_t const misalignment = reinterpret_cast<std::size_t>(m_top) & (alignment - 1);
+        std::size_t const offset = misalignment ? alignment - misalignment : 0;
+        if (size + offset <= std::size_t(m_end - m_top))
+        {
+            char * const p = m_top + offset;
+            m_top = p + size;
+            return p;
+        }
+
+        return allocate_block(size, alignment);
+    }
+
+    /**
+     * \brief Free all memory allocated so far
+     *
+     * One block is kept for the allocations that follow, so an arena that
+     * is released after each request hardly ever calls operator new.
+     */
+    void release()
+    {
+        if (!m_blocks)
+        {
+            return;
+        }
+
+        // blocks for large allocations are not worth keeping
+        block * keep = m_blocks;
+        while (keep && keep->size != m_block_size)
+        {
+            keep = keep->next;
+        }
+
+        free_blocks(keep);
+        m_blocks = keep;
+        m_capacity = keep ? keep->size : 0;
+        m_top = keep ? keep->data() : 0;
+        m_end = keep ? m_top + keep->size : 0;
+    }
+
+    /**
+     * \brief Total size of the blocks held by the arena
+     */
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /**
+     * \brief The arena made current on the calling thread by an arena_scope
+     *
+     * \return 0 if there is none
+     */
+    static arena * current()
+    {
+        return current_ref();
+    }
+
+private:
+    friend class arena_scope;
+
+    struct block
+    {
+        block * next;
+        std::size_t size;
+        std::size_t padding[2];     // keep data() aligned for any type
+
+        char * data()
+        {
+            return reinterpret_cast<char *>(this + 1);
+        }
+    };
+
+    arena(arena const &);
+    arena & operator=(arena const &);
+
+#if defined(LASTJSON_CXX11)
+    static arena * & current_ref()
+    {
+        static thread_local arena * current = 0;
+        return current;
+    }
+#elif defined(__GNUC__)
+    // looked up on every allocation, so avoid thread_specific_ptr if possible
+    static arena * & current_ref()
+    {
+        static __thread arena * current = 0;
+        return current;
+    }
+#else
+    struct current_holder
+    {
+        current_holder()
+            : current(0)
+        {
+        }
+
+        arena * current;
+    };
+
+    static arena * & current_ref()
+    {
+        static boost::thread_specific_ptr<current_holder> holder;
+        if (!holder.get())
+        {
+            holder.reset(new current_holder);
+        }
+
+        return holder->current;
+    }
+#endif
+
+    void * allocate_block(std::size_t size, std::size_t alignment)
+    {
+        std::size_t const needed = size + alignment;
+        if (needed > m_block_size / 4)
+        {
+            // a block of its own, behind the current one, which keeps its free space
+            block * const b = new_block(needed);
+            if (m_blocks)
+            {
+                b->next = m_blocks->next;
+                m_blocks->next = b;
+            }
+            else
+            {
+                b->next = 0;
+                m_blocks = b;
+            }
+
+            return align(b->data(), alignment);
+        }
+
+        block * const b = new_block(m_block_size);
+        b->next = m_blocks;
+        m_blocks = b;
+        m_top = b->data();
+        m_end = m_top + m_block_size;
+        return allocate(size, alignment);
+    }
+
+    block * new_block(std::size_t size)
+    {
+        block * const b = static_cast<block *>(::operator new(sizeof(block) + size));
+        b->size = size;
+        m_capacity += size;
+        return b;
+    }
+
+    void free_blocks(block * keep)
+    {
+        block * b = m_blocks;
+        while (b)
+        {
+            block * const next = b->next;
+            if (b != keep)
+            {
+                ::operator delete(b);
+            }
+            else
+            {
+                b->next = 0;
+            }
+
+            b = next;
+        }
+    }
+
+    static char * align(char * p, std::size_t alignment)
+    {
+        std::size_t const misalignment = reinterpret_cast<std::size_t>(p) & (alignment - 1);
+        return misalignment ? p + (alignment - misalignment) : p;
+    }
+
+    char * m_top;
+    char * m_end;
+    block * m_blocks;               // most recent first
+    std::size_t m_block_size;
+    std::size_t m_capacity;
+};
+
+/**
+ * \brief Makes an arena current on the calling thread for its lifetime
+ *
+ * Scopes may be nested; the previously current arena is restored by the
+ * destructor.
+ */
+class arena_scope
+{
+public:
+    explicit arena_scope(arena & a)
+        : m_previous(arena::current_ref())
+    {
+        arena::current_ref() = &a;
+    }
+
+    ~arena_scope()
+    {
+        arena::current_ref() = m_previous;
+    }
+
+private:
+    arena_scope(arena_scope const &);
+    arena_scope & operator=(arena_scope const &);
+
+    arena * m_previous;
+};
+
+namespace impl {
+
+enum { arena_object_header = 16 };
+
+/**
+ * \brief Allocate an object from the current arena, or the heap if there is none
+ *
+ * A header in front of the object records where it came from.
+ */
+inline void * arena_new(std::size_t size)
+{
+    arena * const a = arena::current();
+    std::size_t const total = size + arena_object_header;
+    char * const p = static_cast<char *>(a ? a->allocate(total, arena_object_header) : ::operator new(total));
+    *reinterpret_cast<arena **>(p) = a;
+    return p + arena_object_header;
+}
+
+inline void arena_delete(void * object)
+{
+    if (!object)
+    {
+        return;
+    }
+
+    char * const p = static_cast<char *>(object) - arena_object_header;
+    if (!*reinterpret_cast<arena **>(p))
+    {
+        ::operator delete(p);
+    }
+}
+
+struct arena_deleter
+{
+    template<class T>
+    void operator()(T * p) const
+    {
+        delete p;
+    }
+};
+
+} // namespace impl
+
+/**
+ * \brief Standard allocator taking its memory from an arena
+ *
+ * A default constructed allocator uses the arena current at the time, and
+ * copies use the same arena. Without a current arena, memory comes from
+ * operator new as with std::allocator.
+ */
+template<class T>
+class arena_allocator
+{
+public:
+    typedef T value_type;
+    typedef T * pointer;
+    typedef T const * const_pointer;
+    typedef T & reference;
+    typedef T const & const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U>
+    struct rebind
+    {
+        typedef arena_allocator<U> other;
+    };
+
+#if __cplusplus >= 201103L
+    // the memory of a container can only be freed by the allocator of its arena
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+#endif
+
+    arena_allocator()
+        : m_arena(arena::current())
+    {
+    }
+
+    template<class U>
+    arena_allocator(arena_allocator<U> const & other)
+        : m_arena(other.get_arena())
+    {
+    }
+
+    pointer allocate(size_type n, void const * = 0)
+    {
+        if (m_arena)
+        {
+#ifdef LASTJSON_CXX11
+            std::size_t const alignment = std::alignment_of<T>::value;
+#else
+            std::size_t const alignment = boost::alignment_of<T>::value;
+#endif
+            return static_cast<pointer>(m_arena->allocate(n * sizeof(T), alignment));
+        }
+
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        if (!m_arena)
+        {
+            ::operator delete(p);
+        }
+    }
+
+    void construct(pointer p, T const & v)
+    {
+        new(static_cast<void *>(p)) T(v);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    pointer address(reference r) const
+    {
+        return &r;
+    }
+
+    const_pointer address(const_reference r) const
+    {
+        return &r;
+    }
+
+    size_type max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    arena * get_arena() const
+    {
+        return m_arena;
+    }
+
+    template<class U>
+    bool operator==(arena_allocator<U> const & other) const
+    {
+        return m_arena == other.get_arena();
+    }
+
+    template<class U>
+    bool operator!=(arena_allocator<U> const & other) const
+    {
+        return m_arena != other.get_arena();
+    }
+
+private:
+    arena * m_arena;
+};
+
+/**
+ * \brief Shared pointer whose reference count is allocated from the arena
+ *
+ * The object is deleted when the last reference goes, so its destructor
+ * runs, but its memory is only reclaimed with the arena's.
+ */
+template<class T>
+class arena_pointer : public shared_ptr<T>
+{
+public:
+    arena_pointer()
+    {
+    }
+
+    explicit arena_pointer(T * p)
+        : shared_ptr<T>(p, impl::arena_deleter(), arena_allocator<T>())
+    {
+    }
+
+    arena_pointer(shared_ptr<T> const & p)
+        : shared_ptr<T>(p)
+    {
+    }
+};
+
+typedef std::basic_string<char, std::char_traits<char>, arena_allocator<char> > arena_string_base;
+
+/**
+ * \brief String allocated from the current arena, including the object itself
+ */
+class arena_string : public arena_string_base
+{
+public:
+    arena_string()
+    {
+    }
+
+    arena_string(arena_string_base const & str)
+        : arena_string_base(str)
+    {
+    }
+
+    arena_string(char const * str)
+        : arena_string_base(str)
+    {
+    }
+
+    arena_string(char const * str, size_type size)
+        : arena_string_base(str, size)
+    {
+    }
+
+    arena_string(std::string const & str)
+        : arena_string_base(str.data(), str.size())
+    {
+    }
+
+    template<class Iterator>
+    arena_string(Iterator begin, Iterator end)
+        : arena_string_base(begin, end)
+    {
+    }
+
+    std::string str() const
+    {
+        return std::string(data(), size());
+    }
+
+    static void * operator new(std::size_t size)
+    {
+        return impl::arena_new(size);
+    }
+
+    static void operator delete(void * p)
+    {
+        impl::arena_delete(p);
+    }
+};
+
+/**
+ * \brief Vector allocated from the current arena, including the object itself
+ */
+template<class T>
+class arena_vector : public std::vector<T, arena_allocator<T> >
+{
+public:
+    typedef std::vector<T, arena_allocator<T> > base_type;
+    typedef typename base_type::size_type size_type;
+
+    arena_vector()
+    {
+    }
+
+    explicit arena_vector(size_type size)
+        : base_type(size)
+    {
+    }
+
+    arena_vector(base_type const & v)
+        : base_type(v)
+    {
+    }
+
+    template<class Iterator>
+    arena_vector(Iterator begin, Iterator end)
+        : base_type(begin, end)
+    {
+    }
+
+    static void * operator new(std::size_t size)
+    {
+        return impl::arena_new(size);
+    }
+
+    static void operator delete(void * p)
+    {
+        impl::arena_delete(p);
+    }
+};
+
+/**
+ * \brief Map allocated from the current arena, including the object itself
+ */
+template<class Key, class T>
+class arena_map : public std::map<Key, T, std::less<Key>, arena_allocator<std::pair<Key const, T> > >
+{
+public:
+    typedef std::map<Key, T, std::less<Key>, arena_allocator<std::pair<Key const, T> > > base_type;
+
+    arena_map()
+    {
+    }
+
+    arena_map(base_type const & m)
+        : base_type(m)
+    {
+    }
+
+    template<class Iterator>
+    arena_map(Iterator begin, Iterator end)
+        : base_type(begin, end)
+    {
+    }
+
+    static void * operator new(std::size_t size)
+    {
+        return impl::arena_new(size);
+    }
+
+    static void operator delete(void * p)
+    {
+        impl::arena_delete(p);
+    }
+};
+
+/**
+ * \brief Properties of a value type that allocates from the current arena
+ *
+ * Strings, arrays, objects, their elements and reference counts all come
+ * from the arena made current by an arena_scope, so parsing a document
+ * allocates next to nothing from the heap:
+ *
+ * \code
+ * lastjson::arena a;
+ * {
+ *     lastjson::arena_scope scope(a);
+ *     lastjson::arena_value request = lastjson::parse<lastjson::arena_value>(data);
+ *     handle(request);
+ * }
+ * a.release();
+ * \endcode
+ *
+ * Values must not outlive the arena they were created in. Without a current
+ * arena, these types allocate from the heap.
+ */
+struct arena_properties
+{
+    typedef basic_value<arena_properties> value;
+
+    typedef bool bool_type;
+    typedef int64_t int_type;
+    typedef double float_type;
+    typedef arena_string string_type;
+    typedef arena_vector<value> array_type;
+    typedef arena_string object_key_type;
+    typedef arena_map<object_key_type, value> object_type;
+
+    typedef arena_pointer<string_type> string_pointer;
+    typedef arena_pointer<array_type> array_pointer;
+    typedef arena_pointer<object_type> object_pointer;
+};
+
+typedef basic_value<arena_properties> arena_value;
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_ARENA_HPP__
@@ -0,0 +1,591 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+
+#ifndef LASTJSON_BINDING_HPP__
+#define LASTJSON_BINDING_HPP__
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+#include "stringrep.hpp"
+#include "impl_helpers.hpp"
+#include "numparse.hpp"
+#include "parse_options.hpp"
+#include "sax.hpp"
+#include "parse.hpp"
+#include "stringify.hpp"
+
+/**
+ * \brief Bind the members of a struct to the keys of a JSON object
+ *
+ * The binding lets parse_struct() read JSON data straight into the struct,
+ * and write_json() and stringify() write it out, without a basic_value in
+ * between:
+ *
+ * \code
+ * struct track
+ * {
+ *     std::string artist;
+ *     int64_t timestamp;
+ *     std::vector<std::string> tags;
+ * };
+ *
+ * LASTJSON_BIND_BEGIN(track)
+ *     LASTJSON_BIND_FIELD(artist)
+ *     LASTJSON_BIND_FIELD_AS(timestamp, "ts")
+ *     LASTJSON_BIND_FIELD(tags)
+ * LASTJSON_BIND_END()
+ * \endcode
+ *
+ * The macros must be used in the global namespace, with the fully
+ * qualified name of the struct. Members may be bools, integers, floats,
+ * std::string, std::vector of any of these, basic_value, and structs with
+ * a binding of their own. Keys are written out as they are, so they must
+ * not need escaping.
+ */
+#define LASTJSON_BIND_BEGIN(type) \
+    namespace lastjson { \
+    template<> \
+    struct binding<type> \
+    { \
+        typedef type bound_type; \
+        \
+        template<class Visitor, class Object> \
+        static bool visit(Visitor & visitor, Object & object) \
+        { \
+            return false
+
+#define LASTJSON_BIND_FIELD_AS(member, key) \
+                || visitor(key, sizeof(key) - 1, object.member)
+
+#define LASTJSON_BIND_FIELD(member) \
+    LASTJSON_BIND_FIELD_AS(member, #member)
+
+#define LASTJSON_BIND_END() \
+            ; \
+        } \
+    }; \
+    }
+
+namespace lastjson {
+
+namespace impl {
+
+/**
+ * \brief Position and remaining nesting depth while reading bound data
+ */
+class binding_reader
+{
+public:
+    binding_reader(char const * begin, char const * end, std::size_t max_depth)
+        : it(begin)
+        , end(end)
+        , depth_left(max_depth)
+    {
+    }
+
+    char const * it;
+    char const * const end;
+    std::size_t depth_left;
+
+    char peek(parse_error_code premature_end = PARSE_PREMATURE_END) const
+    {
+        if (it == end)
+        {
+            throw_parser_error(premature_end);
+        }
+
+        return *it;
+    }
+
+    /**
+     * \brief Consume the given literal if it is next
+     */
+    bool literal(char const * text, std::size_t size)
+    {
+        if (std::size_t(end - it) >= size && std::memcmp(it, text, size) == 0)
+        {
+            it += size;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Consume the opening bracket of an array or object
+     */
+    void enter(parse_error_code premature_end)
+    {
+        if (!depth_left)
+        {
+            throw_parser_error(PARSE_NESTED_TOO_DEEPLY);
+        }
+
+        --depth_left;
+        ++it;
+        skipws(it, end);
+        peek(premature_end);
+    }
+
+    /**
+     * \brief Consume the closing bracket of an array or object
+     */
+    void leave()
+    {
+        ++depth_left;
+        ++it;
+    }
+
+    /**
+     * \brief Consume a key and the colon following it
+     *
+     * [a, b) is valid until the next key is read.
+     */
+    void key(char const * & a, char const * & b)
+    {
+        if (*it != '"')
+        {
+            throw_parser_error(PARSE_INVALID_OBJECT);
+        }
+
+        ++it;
+        a = it;
+        b = find_quote_or_backslash(it, end);
+        if (b != end && *b == '"')
+        {
+            it = b + 1;
+        }
+        else
+        {
+            m_key.clear();
+            unescape_string(it, end, m_key);
+            a = m_key.data();
+            b = a + m_key.size();
+        }
+
+        skipws(it, end);
+        if (peek(PARSE_PREMATURE_END_IN_OBJECT) != ':')
+        {
+            throw_parser_error(PARSE_INVALID_OBJECT);
+        }
+
+        ++it;
+        skipws(it, end);
+    }
+
+    void skip()
+    {
+        skip_value(it, end, depth_left);
+    }
+
+    /**
+     * \brief Throw a type_error for reading the value at it as target
+     */
+    void mismatch(char const * target) const
+    {
+        jsontype type = INT;
+        switch (peek())
+        {
+        case 'n':
+            type = JSONNULL;
+            break;
+        case 't': case 'f':
+            type = BOOL;
+            break;
+        case '"':
+            type = STRING;
+            break;
+        case '[':
+            type = ARRAY;
+            break;
+        case '{':
+            type = OBJECT;
+            break;
+        default:
+            for (char const * p = it; p != end && *p != ',' && *p != ']' && *p != '}'; ++p)
+            {
+                if (*p == '.' || *p == 'e' || *p == 'E')
+                {
+                    type = FLOAT;
+                    break;
+                }
+            }
+        }
+
+        throw type_error("Cannot convert "+std::string(jsontype_name(type))+" to "+target);
+    }
+
+    struct number : sax_handler
+    {
+        jsontype type;
+        int_type i;
+        float_type f;
+
+        void on_int(int_type v)
+        {
+            type = INT;
+            i = v;
+        }
+
+        void on_float(float_type v)
+        {
+            type = FLOAT;
+            f = v;
+        }
+    };
+
+    void read_number(number & num, char const * target)
+    {
+        switch (peek())
+        {
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '+': case '-': case '.':
+            parse_number(it, end, num);
+            return;
+        default:
+            mismatch(target);
+        }
+    }
+
+private:
+    std::string m_key;
+};
+
+/**
+ * \brief Reads JSON data into a value of type T
+ *
+ * Specialised for each supported member type.
+ */
+template<class T, class Enable = void>
+struct field_reader;
+
+template<>
+struct field_reader<bool>
+{
+    static void read(binding_reader & r, bool & out)
+    {
+        if (r.literal("true", 4))
+        {
+            out = true;
+        }
+        else if (r.literal("false", 5))
+        {
+            out = false;
+        }
+        else
+        {
+            r.mismatch("bool");
+        }
+    }
+};
+
+template<class T>
+struct integer_field_reader
+{
+    static void read(binding_reader & r, T & out)
+    {
+        binding_reader::number num;
+        r.read_number(num, "int");
+        if (num.type != INT)
+        {
+            throw type_error("Cannot convert float to int");
+        }
+
+        T const v = T(num.i);
+        if (int64_t(v) != num.i || (v < T(0)) != (num.i < 0))
+        {
+            throw_parser_error(PARSE_NUMBER_OUT_OF_RANGE);
+        }
+
+        out = v;
+    }
+};
+
+template<> struct field_reader<signed char> : integer_field_reader<signed char> {};
+template<> struct field_reader<unsigned char> : integer_field_reader<unsigned char> {};
+template<> struct field_reader<signed short> : integer_field_reader<signed short> {};
+template<> struct field_reader<unsigned short> : integer_field_reader<unsigned short> {};
+template<> struct field_reader<signed int> : integer_field_reader<signed int> {};
+template<> struct field_reader<unsigned int> : integer_field_reader<unsigned int> {};
+template<> struct field_reader<signed long> : integer_field_reader<signed long> {};
+template<> struct field_reader<unsigned long> : integer_field_reader<unsigned long> {};
+template<> struct field_reader<signed long long> : integer_field_reader<signed long long> {};
+template<> struct field_reader<unsigned long long> : integer_field_reader<unsigned long long> {};
+
+template<class T>
+struct float_field_reader
+{
+    static void read(binding_reader & r, T & out)
+    {
+        binding_reader::number num;
+        r.read_number(num, "float");
+        out = num.type == INT ? T(num.i) : T(num.f);
+    }
+};
+
+template<> struct field_reader<float> : float_field_reader<float> {};
+template<> struct field_reader<double> : float_field_reader<double> {};
+
+template<>
+struct field_reader<std::string>
+{
+    static void read(binding_reader & r, std::string & out)
+    {
+        if (r.peek() != '"')
+        {
+            r.mismatch("string");
+        }
+
+        ++r.it;
+        out.clear();
+        unescape_string(r.it, r.end, out);
+    }
+};
+
+template<class T, class Alloc>
+struct field_reader<std::vector<T, Alloc> >
+{
+    static void read(binding_reader & r, std::vector<T, Alloc> & out)
+    {
+        if (r.peek() != '[')
+        {
+            r.mismatch("array");
+        }
+
+        out.clear();
+        r.enter(PARSE_PREMATURE_END_IN_ARRAY);
+        if (*r.it == ']')
+        {
+            r.leave();
+            return;
+        }
+
+        while (true)
+        {
+            out.push_back(T());
+            field_reader<T>::read(r, out.back());
+            skipws(r.it, r.end);
+            char const c = r.peek(PARSE_PREMATURE_END_IN_ARRAY);
+            if (c == ']')
+            {
+                r.leave();
+                return;
+            }
+
+            if (c != ',')
+            {
+                throw_parser_error(PARSE_INVALID_ARRAY);
+            }
+
+            ++r.it;
+            skipws(r.it, r.end);
+        }
+    }
+};
+
+template<class Properties>
+struct field_reader<basic_value<Properties> >
+{
+    static void read(binding_reader & r, basic_value<Properties> & out)
+    {
+        parse_options options;
+        options.max_depth = r.depth_left;
+        parse_fragment<basic_value<Properties> >(r.it, r.end, options).swap(out);
+    }
+};
+
+/**
+ * \brief Visitor reading the value of a key into the member bound to it
+ */
+class member_reader
+{
+public:
+    member_reader(binding_reader & r, char const * key, std::size_t size)
+        : m_reader(r)
+        , m_key(key)
+        , m_size(size)
+    {
+    }
+
+    template<class Member>
+    bool operator()(char const * key, std::size_t size, Member & member)
+    {
+        if (size != m_size || std::memcmp(key, m_key, size) != 0)
+        {
+            return false;
+        }
+
+        // null leaves the member as it is
+        if (!m_reader.literal("null", 4))
+        {
+            field_reader<Member>::read(m_reader, member);
+        }
+
+        return true;
+    }
+
+private:
+    binding_reader & m_reader;
+    char const * m_key;
+    std::size_t m_size;
+};
+
+template<class T>
+struct field_reader<T, typename if_bound<typename binding<T>::bound_type>::type>
+{
+    static void read(binding_reader & r, T & out)
+    {
+        if (r.peek() != '{')
+        {
+            r.mismatch("object");
+        }
+
+        r.enter(PARSE_PREMATURE_END_IN_OBJECT);
+        if (*r.it == '}')
+        {
+            r.leave();
+            return;
+        }
+
+        while (true)
+        {
+            char const * a;
+            char const * b;
+            r.key(a, b);
+            member_reader visitor(r, a, b - a);
+            if (!binding<T>::visit(visitor, out))
+            {
+                r.skip();
+            }
+
+            skipws(r.it, r.end);
+            char const c = r.peek(PARSE_PREMATURE_END_IN_OBJECT);
+            if (c == '}')
+            {
+                r.leave();
+                return;
+            }
+
+            if (c != ',')
+            {
+                throw_parser_error(PARSE_INVALID_OBJECT);
+            }
+
+            ++r.it;
+            skipws(r.it, r.end);
+            r.peek(PARSE_PREMATURE_END_IN_OBJECT);
+        }
+    }
+};
+
+/**
+ * \brief Visitor writing each bound member with its key
+ */
+class member_writer
+{
+public:
+    explicit member_writer(std::ostream & stream)
+        : m_stream(stream)
+        , m_first(true)
+    {
+    }
+
+    template<class Member>
+    bool operator()(char const * key, std::size_t size, Member const & member)
+    {
+        m_stream << (m_first ? "{\"" : ",\"");
+        m_stream.write(key, size);
+        m_stream << "\":";
+        ::lastjson::write_json(m_stream, member);
+        m_first = false;
+        return false;
+    }
+
+    void finish()
+    {
+        m_stream << (m_first ? "{}" : "}");
+    }
+
+private:
+    std::ostream & m_stream;
+    bool m_first;
+};
+
+} // namespace impl
+
+/**
+ * \brief Parse JSON data straight into a struct with a binding
+ *
+ * The data must be a JSON object. The value of each key bound to a member
+ * is read into it, and all other keys are skipped. Members whose key is
+ * missing or null keep their previous value, and vectors are replaced as
+ * a whole. No basic_value is built, except for members of that type.
+ *
+ * \throw parser_error if the data is invalid JSON
+ * \throw type_error if a value does not fit the member it is bound to
+ */
+template<class T>
+inline void parse_struct(char const * begin, char const * end, T & out,
+                         parse_options const & options = parse_options())
+{
+    impl::check_utf8(begin, end, options);
+    impl::binding_reader reader(begin, end, options.max_depth);
+    impl::skipws(reader.it, end);
+    impl::field_reader<T>::read(reader, out);
+    impl::skipws(reader.it, end);
+    if (reader.it != end)
+    {
+        impl::throw_parser_error(PARSE_TRAILING_DATA);
+    }
+}
+
+template<class T>
+inline void parse_struct(std::string const & str, T & out,
+                         parse_options const & options = parse_options())
+{
+    parse_struct(str.data(), str.data() + str.size(), out, options);
+}
+
+/**
+ * \brief Write a struct with a binding as a JSON object
+ *
+ * Members are written in the order they are bound in.
+ */
+template<typename T>
+inline typename impl::if_bound<typename binding<T>::bound_type>::type
+write_json(std::ostream & stream, T const & object)
+{
+    impl::member_writer visitor(stream);
+    binding<T>::visit(visitor, object);
+    visitor.finish();
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_BINDING_HPP__
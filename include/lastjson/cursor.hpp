@@ -0,0 +1,552 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_CURSOR_HPP__
+#define LASTJSON_CURSOR_HPP__
+
+#include <cstring>
+#include <string>
+
+#include "value.hpp"
+#include "stringrep.hpp"
+#include "impl_helpers.hpp"
+#include "numparse.hpp"
+#include "sax.hpp"
+#include "parse.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Forward-only cursor for picking a few values out of JSON data
+ *
+ * The cursor points at a value in the input and moves on as values are
+ * read or skipped. Nothing is allocated while navigating, and values that
+ * are not of interest are skipped by matching brackets without parsing
+ * their contents.
+ *
+ * \code
+ * lastjson::cursor c(data);
+ * if (c.find_field("user") && c.find_field("id"))
+ * {
+ *     int64_t id = c.get_int();
+ * }
+ * \endcode
+ *
+ * find_field() and next_element() enter the object or array the cursor
+ * points at. Called again once the current member or element has been
+ * consumed, they move on within the same container. When the container is
+ * exhausted they return false and leave the cursor behind it. The input
+ * must stay valid and unchanged for the lifetime of the cursor.
+ *
+ * Skipped values are only checked for balanced brackets and terminated
+ * strings; everything the cursor actually reads is fully validated.
+ */
+class cursor
+{
+public:
+    enum { max_depth = 1024 };
+
+    cursor(char const * begin, char const * end)
+        : m_it(begin)
+        , m_end(end)
+        , m_depth(0)
+    {
+        impl::skipws(m_it, m_end);
+    }
+
+    cursor(char const * data, std::size_t size)
+        : m_it(data)
+        , m_end(data + size)
+        , m_depth(0)
+    {
+        impl::skipws(m_it, m_end);
+    }
+
+    explicit cursor(std::string const & str)
+        : m_it(str.data())
+        , m_end(str.data() + str.size())
+        , m_depth(0)
+    {
+        impl::skipws(m_it, m_end);
+    }
+
+    /**
+     * \brief The type of the value at the cursor
+     *
+     * Numbers are reported as INT unless they have a fraction or exponent.
+     */
+    jsontype type() const
+    {
+        switch (peek("premature end of json data"))
+        {
+        case 'n':
+            return JSONNULL;
+        case 't': case 'f':
+            return BOOL;
+        case '"':
+            return STRING;
+        case '[':
+            return ARRAY;
+        case '{':
+            return OBJECT;
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '+': case '-': case '.':
+            for (char const * it = m_it; it != m_end; ++it)
+            {
+                if (*it == '.' || *it == 'e' || *it == 'E')
+                {
+                    return FLOAT;
+                }
+                else if (*it == ',' || *it == ']' || *it == '}' || *it == 0x20
+                         || *it == 0x09 || *it == 0x0a || *it == 0x0d)
+                {
+                    break;
+                }
+            }
+            return INT;
+        default:
+            throw parser_error("invalid json data");
+        }
+    }
+
+    /**
+     * \brief Move to the value of the next member with the given key
+     *
+     * Members are searched in document order, starting from the current
+     * position, and all other members are skipped.
+     *
+     * \return false if the end of the object has been reached
+     */
+    bool find_field(char const * key, std::size_t size)
+    {
+        char const c = peek("premature end of json data while parsing object");
+        if (c == '{')
+        {
+            enter(true);
+            if (peek("premature end of json data while parsing object") == '}')
+            {
+                advance();
+                leave();
+                return false;
+            }
+        }
+        else if (m_depth && in_object() && c == ',')
+        {
+            advance();
+        }
+        else if (m_depth && in_object() && c == '}')
+        {
+            advance();
+            leave();
+            return false;
+        }
+        else
+        {
+            throw type_error("Cannot find field in "+std::string(jsontype_name(type())));
+        }
+
+        char const * const key_end = key + size;
+        while (true)
+        {
+            if (peek("premature end of json data while parsing object") != '"')
+            {
+                throw parser_error("error parsing json object");
+            }
+
+            ++m_it;
+            bool const found = match_string(key, key_end);
+            impl::skipws(m_it, m_end);
+            if (peek("premature end of json data while parsing object") != ':')
+            {
+                throw parser_error("error parsing json object");
+            }
+
+            advance();
+            if (found)
+            {
+                peek("premature end of json data while parsing object");
+                return true;
+            }
+
+            skip();
+            char const next = peek("premature end of json data while parsing object");
+            if (next == '}')
+            {
+                advance();
+                leave();
+                return false;
+            }
+
+            if (next != ',')
+            {
+                throw parser_error("error parsing json object");
+            }
+
+            advance();
+        }
+    }
+
+    bool find_field(char const * key)
+    {
+        return find_field(key, std::strlen(key));
+    }
+
+    bool find_field(std::string const & key)
+    {
+        return find_field(key.data(), key.size());
+    }
+
+    /**
+     * \brief Move to the next element of an array
+     *
+     * \return false if the end of the array has been reached
+     */
+    bool next_element()
+    {
+        char const c = peek("premature end of json data while parsing array");
+        if (c == '[')
+        {
+            enter(false);
+            if (peek("premature end of json data while parsing array") == ']')
+            {
+                advance();
+                leave();
+                return false;
+            }
+
+            return true;
+        }
+        else if (m_depth && !in_object() && c == ',')
+        {
+            advance();
+            peek("premature end of json data while parsing array");
+            return true;
+        }
+        else if (m_depth && !in_object() && c == ']')
+        {
+            advance();
+            leave();
+            return false;
+        }
+
+        throw type_error("Cannot iterate over "+std::string(jsontype_name(type())));
+    }
+
+    /**
+     * \brief Skip the value at the cursor
+     */
+    void skip()
+    {
+        impl::skip_value(m_it, m_end, max_depth - m_depth);
+        impl::skipws(m_it, m_end);
+    }
+
+    /**
+     * \brief Consume a null at the cursor
+     *
+     * \return false, without moving, if the value at the cursor is not null
+     */
+    bool is_null()
+    {
+        if (m_end - m_it >= 4 && std::memcmp(m_it, "null", 4) == 0)
+        {
+            m_it += 4;
+            end_scalar();
+            return true;
+        }
+
+        return false;
+    }
+
+    bool get_bool()
+    {
+        if (m_end - m_it >= 4 && std::memcmp(m_it, "true", 4) == 0)
+        {
+            m_it += 4;
+            end_scalar();
+            return true;
+        }
+        else if (m_end - m_it >= 5 && std::memcmp(m_it, "false", 5) == 0)
+        {
+            m_it += 5;
+            end_scalar();
+            return false;
+        }
+
+        throw type_error("Cannot convert "+std::string(jsontype_name(type()))+" to bool");
+    }
+
+    int64_t get_int()
+    {
+        number_handler num;
+        read_number(num, "int");
+        if (num.type != INT)
+        {
+            throw type_error("Cannot convert float to int");
+        }
+
+        return num.i;
+    }
+
+    double get_float()
+    {
+        number_handler num;
+        read_number(num, "float");
+        return num.type == INT ? double(num.i) : num.f;
+    }
+
+    /**
+     * \brief Consume a string and unescape it into out
+     */
+    void get_string(std::string & out)
+    {
+        expect_string();
+        out.clear();
+        impl::unescape_string(m_it, m_end, out);
+        impl::skipws(m_it, m_end);
+    }
+
+    std::string get_string()
+    {
+        std::string out;
+        get_string(out);
+        return out;
+    }
+
+    /**
+     * \brief Consume a string without unescaping it
+     *
+     * [a, b) is set to the contents of the string as they appear in the
+     * input, with escape sequences left in place.
+     */
+    void get_raw_string(char const * & a, char const * & b)
+    {
+        expect_string();
+        a = m_it;
+        skip_string();
+        b = m_it - 1;
+        impl::skipws(m_it, m_end);
+    }
+
+    /**
+     * \brief Consume the value at the cursor and build a basic_value from it
+     */
+    template<class Value>
+    Value get_value()
+    {
+        Value v = impl::parse_fragment<Value>(m_it, m_end);
+        impl::skipws(m_it, m_end);
+        return v;
+    }
+
+    value get_value()
+    {
+        return get_value<value>();
+    }
+
+    /**
+     * \brief Number of objects and arrays the cursor is inside of
+     */
+    std::size_t depth() const
+    {
+        return m_depth;
+    }
+
+    /**
+     * \brief Whether all of the input has been consumed
+     */
+    bool at_end() const
+    {
+        return m_it == m_end;
+    }
+
+    /**
+     * \brief The current position in the input
+     */
+    char const * position() const
+    {
+        return m_it;
+    }
+
+private:
+    struct number_handler : sax_handler
+    {
+        jsontype type;
+        int_type i;
+        float_type f;
+
+        void on_int(int_type v)
+        {
+            type = INT;
+            i = v;
+        }
+
+        void on_float(float_type v)
+        {
+            type = FLOAT;
+            f = v;
+        }
+    };
+
+    char const * m_it;
+    char const * m_end;
+    std::size_t m_depth;
+    uint64_t m_object_bits[max_depth / 64];
+
+    char peek(char const * premature_end_message) const
+    {
+        if (m_it == m_end)
+        {
+            throw parser_error(premature_end_message);
+        }
+
+        return *m_it;
+    }
+
+    void advance()
+    {
+        ++m_it;
+        impl::skipws(m_it, m_end);
+    }
+
+    void enter(bool object)
+    {
+        if (m_depth == max_depth)
+        {
+            throw parser_error("json data nested too deeply");
+        }
+
+        uint64_t const bit = uint64_t(1) << (m_depth % 64);
+        if (object)
+        {
+            m_object_bits[m_depth / 64] |= bit;
+        }
+        else
+        {
+            m_object_bits[m_depth / 64] &= ~bit;
+        }
+
+        ++m_depth;
+        advance();
+    }
+
+    void leave()
+    {
+        --m_depth;
+    }
+
+    bool in_object() const
+    {
+        return (m_object_bits[(m_depth - 1) / 64] >> ((m_depth - 1) % 64)) & 1;
+    }
+
+    /**
+     * \brief Check that a number or literal ends where it was read up to
+     */
+    void end_scalar()
+    {
+        impl::skipws(m_it, m_end);
+        if (m_it != m_end && *m_it != ',' && *m_it != ']' && *m_it != '}')
+        {
+            throw parser_error("invalid json data");
+        }
+    }
+
+    void expect_string()
+    {
+        if (peek("premature end of json data") != '"')
+        {
+            throw type_error("Cannot convert "+std::string(jsontype_name(type()))+" to string");
+        }
+
+        ++m_it;
+    }
+
+    /**
+     * \brief Skip a string whose opening quote has been consumed
+     */
+    void skip_string()
+    {
+        impl::skip_string(m_it, m_end);
+    }
+
+    /**
+     * \brief Consume a string, comparing its unescaped contents to [a, b)
+     */
+    bool match_string(char const * a, char const * b)
+    {
+        bool match = true;
+        while (m_it != m_end)
+        {
+            char const c = *m_it;
+            if (c == '"')
+            {
+                ++m_it;
+                return match && a == b;
+            }
+            else if (c == '\\')
+            {
+                char decoded[4];
+                char * out = decoded;
+                ++m_it;
+                if (m_it == m_end)
+                {
+                    break;
+                }
+
+                impl::unescape_sequence(m_it, m_end, out);
+                std::size_t const n = out - decoded;
+                match = match && std::size_t(b - a) >= n && std::memcmp(a, decoded, n) == 0;
+                a += match ? n : 0;
+            }
+            else
+            {
+                match = match && a != b && *a == c;
+                a += match ? 1 : 0;
+                ++m_it;
+            }
+        }
+
+        throw parser_error("premature end of json data while parsing string");
+    }
+
+    void read_number(number_handler & num, char const * target)
+    {
+        switch (peek("premature end of json data"))
+        {
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '+': case '-': case '.':
+            impl::parse_number(m_it, m_end, num);
+            end_scalar();
+            return;
+        default:
+            throw type_error("Cannot convert "+std::string(jsontype_name(type()))+" to "+target);
+        }
+    }
+};
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_CURSOR_HPP__
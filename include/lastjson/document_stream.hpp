@@ -0,0 +1,239 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+
+#ifndef LASTJSON_DOCUMENT_STREAM_HPP__
+#define LASTJSON_DOCUMENT_STREAM_HPP__
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+
+#include "value.hpp"
+#include "impl_helpers.hpp"
+#include "parse_options.hpp"
+#include "sax.hpp"
+#include "parse.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Range of the JSON documents stored back to back in one buffer
+ *
+ * Documents may be separated by whitespace or follow each other directly,
+ * as in {"a":1}{"a":2}. Each is parsed where it is, starting where the
+ * previous one ended, when the range is advanced to it:
+ *
+ * \code
+ * lastjson::document_stream docs(data);
+ * for (lastjson::document_stream::iterator it = docs.begin(); it != docs.end(); ++it)
+ * {
+ *     handle(*it);
+ * }
+ * \endcode
+ *
+ * Invalid data throws a parser_error, from next() or from advancing an
+ * iterator, and the stream stays at the start of the invalid document. The
+ * buffer must stay valid and unchanged for the lifetime of the stream.
+ */
+template<class Value>
+class basic_document_stream
+{
+public:
+    typedef Value value_type;
+
+    /**
+     * \brief Input iterator over the remaining documents of a stream
+     *
+     * All iterators of a stream share its position, so only one should be
+     * used at a time.
+     */
+    class iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Value value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value const * pointer;
+        typedef Value const & reference;
+
+        /// The end iterator
+        iterator()
+            : m_stream(0)
+        {
+        }
+
+        reference operator*() const
+        {
+            return m_value;
+        }
+
+        pointer operator->() const
+        {
+            return &m_value;
+        }
+
+        iterator & operator++()
+        {
+            if (!m_stream->next(m_value))
+            {
+                m_stream = 0;
+                m_value = Value();
+            }
+
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator const previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(iterator const & other) const
+        {
+            return m_stream == other.m_stream;
+        }
+
+        bool operator!=(iterator const & other) const
+        {
+            return m_stream != other.m_stream;
+        }
+
+    private:
+        friend class basic_document_stream;
+
+        explicit iterator(basic_document_stream * stream)
+            : m_stream(stream)
+        {
+            ++*this;
+        }
+
+        basic_document_stream * m_stream;
+        Value m_value;
+    };
+
+    /**
+     * \brief Stream over [begin, end), copying strings into the values
+     */
+    basic_document_stream(char const * begin, char const * end,
+                          parse_options const & options = parse_options())
+        : m_it(begin)
+        , m_end(end)
+        , m_events(m_builder, options)
+    {
+        impl::check_utf8(begin, end, options);
+    }
+
+    explicit basic_document_stream(std::string const & str,
+                                   parse_options const & options = parse_options())
+        : m_it(str.data())
+        , m_end(str.data() + str.size())
+        , m_events(m_builder, options)
+    {
+        impl::check_utf8(m_it, m_end, options);
+    }
+
+    /**
+     * \brief Stream over a shared string, which values may reference
+     *
+     * As with parse_shared(), strings without escape sequences refer to
+     * their characters in str rather than being copied.
+     */
+    explicit basic_document_stream(shared_ptr<std::string const> const & str,
+                                   parse_options const & options = parse_options())
+        : m_it(str->data())
+        , m_end(str->data() + str->size())
+        , m_builder(str, m_it, m_end)
+        , m_events(m_builder, options)
+    {
+        impl::check_utf8(m_it, m_end, options);
+        if (options.raw_numbers)
+        {
+            m_builder.keep_number_text(str);
+        }
+    }
+
+    /**
+     * \brief Parse the next document
+     *
+     * \return false, leaving out unchanged, if only whitespace is left
+     */
+    bool next(Value & out)
+    {
+        impl::skipws(m_it, m_end);
+        if (m_it == m_end)
+        {
+            return false;
+        }
+
+        m_builder.reset();
+        if (!m_events.try_parse_value(m_it, m_end))
+        {
+            impl::throw_parser_error(m_events.error());
+        }
+
+        out.swap(m_builder.result());
+        return true;
+    }
+
+    /**
+     * \brief Iterator to the next document, which is parsed right away
+     */
+    iterator begin()
+    {
+        return iterator(this);
+    }
+
+    iterator end()
+    {
+        return iterator();
+    }
+
+    /**
+     * \brief The current position in the input
+     *
+     * This is behind the document parsed last, or at the start of the
+     * document that could not be parsed.
+     */
+    char const * position() const
+    {
+        return m_it;
+    }
+
+private:
+    basic_document_stream(basic_document_stream const &);
+    basic_document_stream & operator=(basic_document_stream const &);
+
+    char const * m_it;
+    char const * m_end;
+    impl::dom_builder<Value> m_builder;
+    impl::event_parser<impl::dom_builder<Value> > m_events;
+};
+
+typedef basic_document_stream<value> document_stream;
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_DOCUMENT_STREAM_HPP__
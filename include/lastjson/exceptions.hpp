@@ -77,6 +77,15 @@ public:
     }
 };
 
+class file_error : public json_error
+{
+public:
+    file_error(std::string const & arg)
+        : json_error(arg)
+    {
+    }
+};
+
 } // namespace lastjson
 
 #endif // ifndef LASTJSON_EXCEPTIONS_HPP__
@@ -23,6 +23,7 @@ THE SOFTWARE.
 #ifndef LASTJSON_IMPL_HELPERS_HPP__
 #define LASTJSON_IMPL_HELPERS_HPP__
 
+#include <new>
 #include <string>
 #include <stdexcept>
 
@@ -35,6 +36,7 @@ THE SOFTWARE.
 #endif
 
 #include "exceptions.hpp"
+#include "parse_result.hpp"
 
 namespace lastjson {
 
@@ -79,20 +81,35 @@ inline void skipws(Iterator & begin, Iterator end)
     }
 }
 
+/**
+ * \brief Throws the exception parse() reports an error code with
+ */
+inline void throw_parser_error(parse_error_code code)
+{
+    if (code == PARSE_OUT_OF_MEMORY)
+    {
+        throw std::bad_alloc();
+    }
+
+    throw parser_error(parse_error_message(code));
+}
+
 /**
  * \brief Consumes 4 characters as a hexadecimal literal and converts them to a number
+ *
+ * \return PARSE_OK, or the reason rv could not be read
  */
 template<class Iterator>
-inline uint16_t read4hex(Iterator & it, Iterator end)
+inline parse_error_code try_read4hex(Iterator & it, Iterator end, uint16_t & rv)
 {
-    uint16_t rv = 0;
+    rv = 0;
 
     for (int i = 0; i < 4; ++i)
     {
         if (it == end)
         {
             // we reached the end of the string before we got 4 characters
-            throw parser_error("premature end of json string");
+            return PARSE_PREMATURE_END_IN_ESCAPE;
         }
 
         char const c = *it;
@@ -115,12 +132,25 @@ inline uint16_t read4hex(Iterator & it, Iterator end)
         }
         else
         {
-            throw parser_error("error decoding unicode escape sequence");
+            return PARSE_INVALID_UNICODE_ESCAPE;
         }
 
         ++it;
     }
 
+    return PARSE_OK;
+}
+
+template<class Iterator>
+inline uint16_t read4hex(Iterator & it, Iterator end)
+{
+    uint16_t rv;
+    parse_error_code const code = try_read4hex(it, end, rv);
+    if (code)
+    {
+        throw_parser_error(code);
+    }
+
     return rv;
 }
 
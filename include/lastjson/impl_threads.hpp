@@ -0,0 +1,77 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_IMPL_THREADS_HPP__
+#define LASTJSON_IMPL_THREADS_HPP__
+
+#include <cstddef>
+
+#ifdef LASTJSON_CXX11
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+#else
+# include <boost/thread/thread.hpp>
+# include <boost/thread/mutex.hpp>
+# include <boost/thread/locks.hpp>
+# include <boost/thread/condition_variable.hpp>
+#endif
+
+namespace lastjson {
+namespace impl {
+
+#ifdef LASTJSON_CXX11
+typedef std::thread thread;
+typedef std::mutex mutex;
+typedef std::unique_lock<std::mutex> unique_lock;
+typedef std::condition_variable condition_variable;
+
+inline unsigned hardware_concurrency()
+{
+    return std::thread::hardware_concurrency();
+}
+#else
+typedef boost::thread thread;
+typedef boost::mutex mutex;
+typedef boost::unique_lock<boost::mutex> unique_lock;
+typedef boost::condition_variable condition_variable;
+
+inline unsigned hardware_concurrency()
+{
+    return boost::thread::hardware_concurrency();
+}
+#endif
+
+/**
+ * \brief Number of worker threads to use when 0 was requested
+ */
+inline std::size_t default_thread_count()
+{
+    unsigned const n = hardware_concurrency();
+    return n ? n : 1;
+}
+
+} // namespace impl
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_IMPL_THREADS_HPP__
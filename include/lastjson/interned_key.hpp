@@ -0,0 +1,258 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_INTERNED_KEY_HPP__
+#define LASTJSON_INTERNED_KEY_HPP__
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef LASTJSON_CXX11
+# include <unordered_map>
+#else
+# include <boost/unordered_map.hpp>
+# include <boost/thread/tss.hpp>
+#endif
+
+#include "value.hpp"
+#include "impl_helpers.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Table of interned strings
+ *
+ * Interning a string returns the one shared copy of it held by the table.
+ * Once the table is full, further strings are returned as copies of their
+ * own, so hostile input cannot make it grow without bounds. A table must
+ * not be used by several threads at once.
+ */
+class key_table
+{
+public:
+    enum { default_capacity = 4096 };
+
+    key_table(std::size_t capacity = default_capacity)
+        : m_capacity(capacity)
+    {
+    }
+
+    /**
+     * \brief Return the shared copy of [a, b)
+     */
+    shared_ptr<std::string const> intern(char const * a, char const * b)
+    {
+        m_probe.assign(a, b);
+        map_type::const_iterator it = m_strings.find(m_probe);
+        if (it != m_strings.end())
+        {
+            return it->second;
+        }
+
+        shared_ptr<std::string const> str(new std::string(m_probe));
+        if (m_strings.size() < m_capacity)
+        {
+            m_strings.insert(std::make_pair(m_probe, str));
+        }
+
+        return str;
+    }
+
+    /// Number of strings in the table
+    std::size_t size() const
+    {
+        return m_strings.size();
+    }
+
+    /// Maximum number of strings in the table
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    void set_capacity(std::size_t capacity)
+    {
+        m_capacity = capacity;
+    }
+
+    /**
+     * \brief Forget all strings
+     *
+     * Strings that were handed out stay valid, but are no longer shared with
+     * strings interned from now on.
+     */
+    void clear()
+    {
+        m_strings.clear();
+    }
+
+    /**
+     * \brief The table used by interned_key on the calling thread
+     */
+    static key_table & local()
+    {
+#ifdef LASTJSON_CXX11
+        static thread_local key_table table;
+        return table;
+#else
+        static boost::thread_specific_ptr<key_table> table;
+        if (!table.get())
+        {
+            table.reset(new key_table);
+        }
+
+        return *table;
+#endif
+    }
+
+private:
+#ifdef LASTJSON_CXX11
+    typedef std::unordered_map<std::string, shared_ptr<std::string const> > map_type;
+#else
+    typedef boost::unordered_map<std::string, shared_ptr<std::string const> > map_type;
+#endif
+
+    map_type m_strings;
+    std::string m_probe;
+    std::size_t m_capacity;
+};
+
+/**
+ * \brief Object key sharing its characters with all equal keys
+ *
+ * Keys are interned in the key_table of the thread creating them, so the
+ * keys of objects parsed from record-oriented data all share a handful of
+ * strings. Comparing two keys from the same table is a pointer comparison
+ * when they are equal. Keys are ordered like std::string.
+ */
+class interned_key
+{
+public:
+    interned_key()
+    {
+    }
+
+    interned_key(std::string const & str)
+        : m_str(key_table::local().intern(str.data(), str.data() + str.size()))
+    {
+    }
+
+    interned_key(char const * str)
+        : m_str(key_table::local().intern(str, str + std::char_traits<char>::length(str)))
+    {
+    }
+
+    interned_key(char const * a, char const * b)
+        : m_str(key_table::local().intern(a, b))
+    {
+    }
+
+    void assign(char const * a, char const * b)
+    {
+        m_str = key_table::local().intern(a, b);
+    }
+
+    std::string const & str() const
+    {
+        static std::string const empty_string;
+        return m_str ? *m_str : empty_string;
+    }
+
+    operator std::string const & () const
+    {
+        return str();
+    }
+
+    char const * data() const
+    {
+        return str().data();
+    }
+
+    char const * c_str() const
+    {
+        return str().c_str();
+    }
+
+    std::size_t size() const
+    {
+        return str().size();
+    }
+
+    bool empty() const
+    {
+        return str().empty();
+    }
+
+    friend bool operator==(interned_key const & a, interned_key const & b)
+    {
+        return a.m_str == b.m_str || a.str() == b.str();
+    }
+
+    friend bool operator!=(interned_key const & a, interned_key const & b)
+    {
+        return !(a == b);
+    }
+
+    friend bool operator<(interned_key const & a, interned_key const & b)
+    {
+        return a.m_str != b.m_str && a.str() < b.str();
+    }
+
+private:
+    shared_ptr<std::string const> m_str;
+};
+
+inline std::ostream & operator<<(std::ostream & out, interned_key const & key)
+{
+    return out << key.str();
+}
+
+/**
+ * \brief Properties of a value type whose object keys are interned
+ *
+ * Other than the key type, these are the same as standard_properties.
+ */
+struct interned_properties
+{
+    typedef basic_value<interned_properties> value;
+
+    typedef bool bool_type;
+    typedef int64_t int_type;
+    typedef double float_type;
+    typedef std::string string_type;
+    typedef std::vector<value> array_type;
+    typedef interned_key object_key_type;
+    typedef std::map<object_key_type, value> object_type;
+
+    typedef shared_ptr<string_type> string_pointer;
+    typedef shared_ptr<array_type> array_pointer;
+    typedef shared_ptr<object_type> object_pointer;
+};
+
+typedef basic_value<interned_properties> interned_value;
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_INTERNED_KEY_HPP__
@@ -0,0 +1,333 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_LAZY_PARSE_HPP__
+#define LASTJSON_LAZY_PARSE_HPP__
+
+#include <string>
+
+#include "value.hpp"
+#include "parse.hpp"
+#include "parse_options.hpp"
+#include "sax.hpp"
+#include "impl_helpers.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Settings for parsing with deferred subtrees
+ */
+struct lazy_options
+{
+    lazy_options()
+        : depth(1)
+    {
+    }
+
+    /// Arrays and objects nested within this many containers are not parsed until accessed
+    std::size_t depth;
+
+    /// Settings for parsing the document and its subtrees
+    parse_options parse;
+};
+
+namespace impl {
+
+/**
+ * \brief Parse the slice of a lazy subtree into its array or object
+ */
+template<class Value>
+inline void parse_lazy_subtree(lazy_subtree & subtree)
+{
+    parse_options options;
+    options.max_depth = subtree.max_depth;
+    Value v = impl::parse_shared<Value>(subtree.begin, subtree.end, subtree.buffer, options);
+    if (v.is_array())
+    {
+        subtree.parsed = v.get_array_pointer();
+    }
+    else
+    {
+        subtree.parsed = v.get_object_pointer();
+    }
+}
+
+/**
+ * \brief Parser building values whose deeper subtrees are left unparsed
+ *
+ * The containers above the lazy depth are parsed here, scalars are handed
+ * to the event parser. Deferred subtrees are only scanned for their closing
+ * bracket, so errors within them surface when they are first accessed.
+ */
+template<class Value>
+class lazy_parser
+{
+public:
+    lazy_parser(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                lazy_options const & options)
+        : m_buffer(buffer)
+        , m_options(options)
+        , m_builder(buffer, begin, end)
+        , m_events(m_builder, options.parse)
+    {
+    }
+
+    void parse_value(char const * & it, char const * end, std::size_t depth, Value & result)
+    {
+        skipws(it, end);
+        if (it == end)
+        {
+            throw parser_error("premature end of json data");
+        }
+
+        if (*it != '[' && *it != '{')
+        {
+            m_events.parse_value(it, end);
+            result.swap(m_builder.result());
+            return;
+        }
+
+        if (depth >= m_options.parse.max_depth)
+        {
+            throw parser_error("json data nested too deeply");
+        }
+
+        if (depth >= m_options.depth)
+        {
+            defer(it, end, depth, result);
+        }
+        else if (*it == '[')
+        {
+            parse_array(it, end, depth, result);
+        }
+        else
+        {
+            parse_object(it, end, depth, result);
+        }
+    }
+
+private:
+    shared_ptr<void const> m_buffer;
+    lazy_options m_options;
+    dom_builder<Value> m_builder;
+    event_parser<dom_builder<Value> > m_events;
+    typename Value::object_key_type m_key;
+
+    void parse_array(char const * & it, char const * end, std::size_t depth, Value & result)
+    {
+        typename Value::array_pointer array_ptr(new typename Value::array_type);
+        ++it;
+        skipws(it, end);
+        if (it != end && *it == ']')
+        {
+            ++it;
+        }
+        else
+        {
+            for (;;)
+            {
+                array_ptr->push_back(Value());
+                parse_value(it, end, depth + 1, array_ptr->back());
+
+                skipws(it, end);
+                if (it == end)
+                {
+                    throw parser_error("premature end of json data while parsing array");
+                }
+
+                char const c = *(it++);
+                if (c == ']')
+                {
+                    break;
+                }
+                else if (c != ',')
+                {
+                    throw parser_error("error parsing json array");
+                }
+            }
+        }
+
+        Value(array_ptr).swap(result);
+    }
+
+    void parse_object(char const * & it, char const * end, std::size_t depth, Value & result)
+    {
+        typename Value::object_pointer object_ptr(new typename Value::object_type);
+        ++it;
+        skipws(it, end);
+        if (it != end && *it == '}')
+        {
+            ++it;
+        }
+        else
+        {
+            for (;;)
+            {
+                skipws(it, end);
+                if (it == end)
+                {
+                    throw parser_error("premature end of json data while parsing object");
+                }
+                if (*it != '"')
+                {
+                    throw parser_error("error parsing json object");
+                }
+
+                char const * a;
+                char const * b;
+                ++it;
+                m_events.read_string(it, end, a, b);
+                m_key.assign(a, b);
+
+                skipws(it, end);
+                if (it == end)
+                {
+                    throw parser_error("premature end of json data while parsing object");
+                }
+                if (*(it++) != ':')
+                {
+                    throw parser_error("error parsing json object");
+                }
+
+                parse_value(it, end, depth + 1, (*object_ptr)[m_key]);
+
+                skipws(it, end);
+                if (it == end)
+                {
+                    throw parser_error("premature end of json data while parsing object");
+                }
+
+                char const c = *(it++);
+                if (c == '}')
+                {
+                    break;
+                }
+                else if (c != ',')
+                {
+                    throw parser_error("error parsing json object");
+                }
+            }
+        }
+
+        Value(object_ptr).swap(result);
+    }
+
+    /**
+     * \brief Skip to the end of the array or object at it and keep its slice
+     */
+    void defer(char const * & it, char const * end, std::size_t depth, Value & result)
+    {
+        shared_ptr<lazy_subtree> subtree(new lazy_subtree);
+        subtree->buffer = m_buffer;
+        subtree->begin = it;
+        subtree->max_depth = m_options.parse.max_depth - depth;
+        subtree->parse = &parse_lazy_subtree<Value>;
+
+        jsontype const type = *it == '[' ? ARRAY : OBJECT;
+        skip_value(it, end, subtree->max_depth);
+
+        subtree->end = it;
+        Value(type, subtree).swap(result);
+    }
+};
+
+template<class Value>
+inline Value parse_lazy(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                        lazy_options const & options)
+{
+    // deferred subtrees lie within the range, so they need no check of their own
+    check_utf8(begin, end, options.parse);
+
+    Value result;
+    lazy_parser<Value>(begin, end, buffer, options).parse_value(begin, end, 0, result);
+
+    skipws(begin, end);
+    if (begin != end)
+    {
+        throw parser_error("additional data at the end of json data");
+    }
+
+    return result;
+}
+
+} // namespace impl
+
+/**
+ * \brief Parse JSON data, deferring arrays and objects below a given depth
+ *
+ * Arrays and objects nested within options.depth containers are not parsed,
+ * but only scanned for their end and stored as slices of the input. They
+ * are parsed when their contents are first accessed, with any errors in
+ * them reported then. A subtree that is never accessed is written out by
+ * write_json exactly as it appeared in the input.
+ *
+ * The values keep a reference to buffer, which must own [begin, end).
+ * Accessing a lazy subtree modifies it, so values sharing unparsed subtrees
+ * must not be read from several threads at once.
+ */
+template<class Value>
+inline Value parse_lazy(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                        lazy_options const & options = lazy_options())
+{
+    return impl::parse_lazy<Value>(begin, end, buffer, options);
+}
+
+/**
+ * \brief Parse JSON data held by a shared string, deferring deep subtrees
+ */
+template<class Value>
+inline Value parse_lazy(shared_ptr<std::string const> const & str,
+                        lazy_options const & options = lazy_options())
+{
+    return impl::parse_lazy<Value>(str->data(), str->data() + str->size(), str, options);
+}
+
+/**
+ * \brief Parse a copy of the given JSON data, deferring deep subtrees
+ */
+template<class Value>
+inline Value parse_lazy(std::string const & str, lazy_options const & options = lazy_options())
+{
+    return parse_lazy<Value>(shared_ptr<std::string const>(new std::string(str)), options);
+}
+
+inline value parse_lazy(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                        lazy_options const & options = lazy_options())
+{
+    return parse_lazy<value>(begin, end, buffer, options);
+}
+
+inline value parse_lazy(shared_ptr<std::string const> const & str,
+                        lazy_options const & options = lazy_options())
+{
+    return parse_lazy<value>(str, options);
+}
+
+inline value parse_lazy(std::string const & str, lazy_options const & options = lazy_options())
+{
+    return parse_lazy<value>(str, options);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_LAZY_PARSE_HPP__
@@ -0,0 +1,189 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_MAPPED_FILE_HPP__
+#define LASTJSON_MAPPED_FILE_HPP__
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "exceptions.hpp"
+#include "parse.hpp"
+#include "lazy_parse.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief A file mapped read-only into memory
+ *
+ * The whole file is mapped on construction and unmapped on destruction.
+ * The kernel is told that the mapping will be read sequentially, so it can
+ * read ahead aggressively and drop pages behind the reader.
+ */
+class mapped_file
+{
+public:
+    /**
+     * \brief Map the file at the given path
+     *
+     * \throw file_error if the file cannot be opened or mapped
+     */
+    explicit mapped_file(std::string const & path)
+        : m_data(0)
+        , m_size(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            fail("cannot open", path);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            fail("cannot stat", path);
+        }
+
+        m_size = std::size_t(st.st_size);
+        if (m_size)
+        {
+            void * data = ::mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                fail("cannot map", path);
+            }
+            m_data = static_cast<char const *>(data);
+#ifdef MADV_SEQUENTIAL
+            ::madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+            ::madvise(data, m_size, MADV_WILLNEED);
+#endif
+        }
+
+        // the mapping stays valid without the descriptor
+        ::close(fd);
+    }
+
+    ~mapped_file()
+    {
+        if (m_data)
+        {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+    }
+
+    /// First byte of the file contents (null for an empty file)
+    char const * data() const
+    {
+        return m_data;
+    }
+
+    /// Size of the file in bytes
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    char const * begin() const
+    {
+        return m_data;
+    }
+
+    char const * end() const
+    {
+        return m_data + m_size;
+    }
+
+private:
+    mapped_file(mapped_file const &);
+    mapped_file & operator=(mapped_file const &);
+
+    static void fail(char const * what, std::string const & path)
+    {
+        throw file_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+    }
+
+    char const * m_data;
+    std::size_t m_size;
+};
+
+/**
+ * \brief Parse the JSON file at the given path
+ *
+ * The file is mapped into memory and parsed straight from the mapping, so
+ * it is never read into a buffer of its own. The mapping is released
+ * before this function returns; see parse_file_lazy() for keeping it.
+ *
+ * \throw file_error if the file cannot be read
+ * \throw parser_error if the file does not contain valid JSON data
+ */
+template<class Value>
+inline Value parse_file(std::string const & path, parse_options const & options = parse_options())
+{
+    mapped_file file(path);
+    return impl::parse<Value>(file.begin(), file.end(), options);
+}
+
+inline value parse_file(std::string const & path, parse_options const & options = parse_options())
+{
+    return parse_file<value>(path, options);
+}
+
+/**
+ * \brief Parse the JSON file at the given path, deferring deep subtrees
+ *
+ * Like parse_lazy(), arrays and objects below options.depth are only parsed
+ * when accessed. The file stays mapped for as long as any value still
+ * refers to an unparsed subtree.
+ *
+ * \throw file_error if the file cannot be read
+ * \throw parser_error if the file does not contain valid JSON data
+ */
+template<class Value>
+inline Value parse_file_lazy(std::string const & path, lazy_options const & options = lazy_options())
+{
+    shared_ptr<mapped_file> file(new mapped_file(path));
+    return impl::parse_lazy<Value>(file->begin(), file->end(), file, options);
+}
+
+inline value parse_file_lazy(std::string const & path, lazy_options const & options = lazy_options())
+{
+    return parse_file_lazy<value>(path, options);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_MAPPED_FILE_HPP__
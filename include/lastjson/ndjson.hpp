@@ -0,0 +1,381 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_NDJSON_HPP__
+#define LASTJSON_NDJSON_HPP__
+
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+#include "parse.hpp"
+#include "parse_options.hpp"
+#include "impl_helpers.hpp"
+#include "impl_threads.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Settings for parsing newline-delimited JSON
+ */
+struct ndjson_options
+{
+    ndjson_options()
+        : threads(0)
+        , batch_size(64 * 1024)
+    {
+    }
+
+    /// Number of worker threads, or 0 for one per hardware thread
+    std::size_t threads;
+
+    /// Approximate number of bytes handed to a worker at a time
+    std::size_t batch_size;
+
+    /// Settings for parsing each record
+    parse_options parse;
+};
+
+/**
+ * \brief One record of newline-delimited JSON
+ */
+template<class Value>
+struct basic_ndjson_record
+{
+    basic_ndjson_record()
+        : line(0)
+    {
+    }
+
+    /// Line number of the record in the input, counting from 1
+    std::size_t line;
+
+    /// The parsed value, null if the record could not be parsed
+    Value value;
+
+    /// Empty if the record was parsed, otherwise the error message
+    std::string error;
+
+    bool ok() const
+    {
+        return error.empty();
+    }
+};
+
+typedef basic_ndjson_record<value> ndjson_record;
+
+/**
+ * \brief Parses newline-delimited JSON on a pool of worker threads
+ *
+ * The input is cut into batches of whole lines, which the workers parse
+ * concurrently. Records are handed back in input order. Lines that contain
+ * only whitespace are skipped, and a line that fails to parse yields a
+ * record with an error message instead of aborting the batch.
+ *
+ * The worker threads are started by the constructor and kept until the
+ * parser is destroyed, so the parser should be reused. Only one thread at a
+ * time may call parse().
+ */
+template<class Value>
+class basic_ndjson_parser
+{
+public:
+    typedef Value value_type;
+    typedef basic_ndjson_record<Value> record_type;
+
+    explicit basic_ndjson_parser(ndjson_options const & options = ndjson_options())
+        : m_options(options)
+        , m_stop(false)
+    {
+        if (!m_options.threads)
+        {
+            m_options.threads = impl::default_thread_count();
+        }
+
+        if (!m_options.batch_size)
+        {
+            m_options.batch_size = 1;
+        }
+
+        try
+        {
+            for (std::size_t i = 0; i < m_options.threads; ++i)
+            {
+                worker w = { this };
+                m_threads.push_back(shared_ptr<impl::thread>(new impl::thread(w)));
+            }
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    ~basic_ndjson_parser()
+    {
+        stop();
+    }
+
+    /**
+     * \brief Parse all records and pass them to a callback in input order
+     *
+     * The callback is called with a record_type & from the calling thread.
+     * It may take the value out of the record by swapping it.
+     */
+    template<class Callback>
+    void parse(char const * begin, char const * end, Callback & callback)
+    {
+        std::size_t const max_in_flight = 2 * m_threads.size();
+        std::deque<batch> batches;
+        std::size_t line = 0;
+
+        try
+        {
+            while (begin != end || !batches.empty())
+            {
+                while (begin != end && batches.size() < max_in_flight)
+                {
+                    char const * batch_end = end;
+                    if (std::size_t(end - begin) > m_options.batch_size)
+                    {
+                        char const * const nl = static_cast<char const *>(
+                            std::memchr(begin + m_options.batch_size, '\n',
+                                        end - begin - m_options.batch_size));
+                        batch_end = nl ? nl + 1 : end;
+                    }
+
+                    batches.push_back(batch(begin, batch_end));
+                    {
+                        impl::unique_lock lock(m_mutex);
+                        m_queue.push_back(&batches.back());
+                    }
+
+                    m_work_cv.notify_one();
+                    begin = batch_end;
+                }
+
+                batch & b = batches.front();
+                {
+                    impl::unique_lock lock(m_mutex);
+                    while (!b.done)
+                    {
+                        m_done_cv.wait(lock);
+                    }
+                }
+
+                for (std::size_t i = 0; i < b.records.size(); ++i)
+                {
+                    b.records[i].line += line;
+                    callback(b.records[i]);
+                }
+
+                line += b.lines;
+                batches.pop_front();
+            }
+        }
+        catch (...)
+        {
+            // the workers must be done with our batches before they go away
+            impl::unique_lock lock(m_mutex);
+            m_queue.clear();
+            for (std::size_t i = 0; i < batches.size(); ++i)
+            {
+                while (!batches[i].done && batches[i].started)
+                {
+                    m_done_cv.wait(lock);
+                }
+            }
+
+            throw;
+        }
+    }
+
+    /**
+     * \brief Parse all records into a vector, in input order
+     */
+    std::vector<record_type> parse(char const * begin, char const * end)
+    {
+        std::vector<record_type> records;
+        collector collect = { records };
+        parse(begin, end, collect);
+        return records;
+    }
+
+    std::vector<record_type> parse(std::string const & str)
+    {
+        return parse(str.data(), str.data() + str.size());
+    }
+
+    /**
+     * \brief Number of worker threads
+     */
+    std::size_t threads() const
+    {
+        return m_threads.size();
+    }
+
+private:
+    struct batch
+    {
+        batch(char const * b, char const * e)
+            : begin(b)
+            , end(e)
+            , lines(0)
+            , started(false)
+            , done(false)
+        {
+        }
+
+        char const * begin;
+        char const * end;
+        std::vector<record_type> records;   // line numbers relative to the batch
+        std::size_t lines;
+        bool started;
+        bool done;
+    };
+
+    struct worker
+    {
+        basic_ndjson_parser * parser;
+
+        void operator()()
+        {
+            parser->work();
+        }
+    };
+
+    struct collector
+    {
+        std::vector<record_type> & records;
+
+        void operator()(record_type & record)
+        {
+            records.push_back(record_type());
+            records.back().line = record.line;
+            records.back().value.swap(record.value);
+            records.back().error.swap(record.error);
+        }
+    };
+
+    ndjson_options m_options;
+    std::vector<shared_ptr<impl::thread> > m_threads;
+    impl::mutex m_mutex;
+    impl::condition_variable m_work_cv;     // signalled when a batch is queued
+    impl::condition_variable m_done_cv;     // signalled when a batch is done
+    std::deque<batch *> m_queue;
+    bool m_stop;
+
+    // not copyable
+    basic_ndjson_parser(basic_ndjson_parser const &);
+    basic_ndjson_parser & operator=(basic_ndjson_parser const &);
+
+    void stop()
+    {
+        {
+            impl::unique_lock lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_work_cv.notify_all();
+        for (std::size_t i = 0; i < m_threads.size(); ++i)
+        {
+            m_threads[i]->join();
+        }
+    }
+
+    void work()
+    {
+        impl::unique_lock lock(m_mutex);
+        while (true)
+        {
+            while (!m_stop && m_queue.empty())
+            {
+                m_work_cv.wait(lock);
+            }
+
+            if (m_stop)
+            {
+                return;
+            }
+
+            batch & b = *m_queue.front();
+            m_queue.pop_front();
+            b.started = true;
+            lock.unlock();
+            parse_batch(b);
+            lock.lock();
+            b.done = true;
+            m_done_cv.notify_all();
+        }
+    }
+
+    void parse_batch(batch & b)
+    {
+        char const * it = b.begin;
+        while (it != b.end)
+        {
+            char const * nl = static_cast<char const *>(std::memchr(it, '\n', b.end - it));
+            char const * const line_end = nl ? nl : b.end;
+
+            char const * first = it;
+            impl::skipws(first, line_end);
+            if (first != line_end)
+            {
+                b.records.push_back(record_type());
+                record_type & record = b.records.back();
+                record.line = b.lines + 1;
+                try
+                {
+                    Value v = impl::parse<Value>(first, line_end, m_options.parse);
+                    record.value.swap(v);
+                }
+                catch (std::exception const & e)
+                {
+                    record.error = e.what();
+                }
+            }
+
+            ++b.lines;
+            it = nl ? nl + 1 : b.end;
+        }
+    }
+};
+
+typedef basic_ndjson_parser<value> ndjson_parser;
+
+/**
+ * \brief Parse newline-delimited JSON on a temporary pool of threads
+ */
+inline std::vector<ndjson_record> parse_ndjson(std::string const & str,
+                                               ndjson_options const & options = ndjson_options())
+{
+    return ndjson_parser(options).parse(str);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_NDJSON_HPP__
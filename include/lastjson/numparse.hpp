@@ -0,0 +1,483 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+#ifndef LASTJSON_NUMPARSE_HPP__
+#define LASTJSON_NUMPARSE_HPP__
+
+#include <cfloat>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+#include "impl_helpers.hpp"
+#include "impl_pow5_table.hpp"
+
+namespace lastjson {
+
+namespace impl {
+
+/**
+ * \brief A decimal number split into its significant digits and exponent
+ *
+ * The number is mantissa * 10^exponent. At most 19 significant digits are
+ * kept in the mantissa. If non-zero digits had to be dropped, truncated is
+ * set and the real number lies between mantissa and mantissa + 1 (times
+ * 10^exponent).
+ */
+struct decimal_number
+{
+    uint64_t mantissa;
+    int64_t exponent;
+    bool negative;
+    bool truncated;
+};
+
+struct uint128
+{
+    uint64_t low;
+    uint64_t high;
+};
+
+inline uint128 full_multiplication(uint64_t a, uint64_t b)
+{
+    uint128 r;
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 const p = static_cast<unsigned __int128>(a) * b;
+    r.low = uint64_t(p);
+    r.high = uint64_t(p >> 64);
+#else
+    uint64_t const a_lo = uint32_t(a), a_hi = a >> 32;
+    uint64_t const b_lo = uint32_t(b), b_hi = b >> 32;
+    uint64_t const lo_lo = a_lo * b_lo;
+    uint64_t const hi_lo = a_hi * b_lo;
+    uint64_t const lo_hi = a_lo * b_hi;
+    uint64_t const hi_hi = a_hi * b_hi;
+    uint64_t const cross = (lo_lo >> 32) + uint32_t(hi_lo) + lo_hi;
+    r.high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    r.low = (cross << 32) | uint32_t(lo_lo);
+#endif
+    return r;
+}
+
+inline int count_leading_zeros(uint64_t x)
+{
+#ifdef __GNUC__
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (uint64_t(1) << 63)))
+    {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * \brief Clinger's fast path
+ *
+ * If mantissa and power of ten are both exactly representable as doubles, a
+ * single correctly rounded multiplication or division yields the correctly
+ * rounded result.
+ *
+ * \return false if the fast path is not applicable
+ */
+inline bool clinger_fast_path(decimal_number const & num, double & result)
+{
+    static double const powers_of_ten[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+    // x87 style extended precision intermediates would round twice
+    return false;
+#endif
+
+    if (num.truncated || num.mantissa > (uint64_t(1) << 53)
+        || num.exponent < -22 || num.exponent > 22)
+    {
+        return false;
+    }
+
+    double value = double(num.mantissa);
+    if (num.exponent < 0)
+    {
+        value /= powers_of_ten[-num.exponent];
+    }
+    else
+    {
+        value *= powers_of_ten[num.exponent];
+    }
+
+    result = num.negative ? -value : value;
+    return true;
+}
+
+/**
+ * \brief Eisel-Lemire algorithm for mantissa * 10^exponent
+ *
+ * Multiplies the normalised mantissa with a 128 bit approximation of the
+ * power of ten and rounds the result to 53 bits. For mantissas of up to 19
+ * digits the 128 bit product is always precise enough.
+ *
+ * \return The IEEE 754 bit pattern of the absolute value
+ */
+inline uint64_t eisel_lemire(uint64_t mantissa, int64_t exponent)
+{
+    int const mantissa_bits = 52;
+    int const minimum_exponent = -1023;
+    int const infinite_power = 0x7ff;
+
+    if (mantissa == 0 || exponent < pow5_table<void>::smallest_power)
+    {
+        return 0;
+    }
+
+    if (exponent > pow5_table<void>::largest_power)
+    {
+        return uint64_t(infinite_power) << mantissa_bits;
+    }
+
+    int const q = int(exponent);
+    int const lz = count_leading_zeros(mantissa);
+    uint64_t const w = mantissa << lz;
+
+    int const index = 2 * (q - pow5_table<void>::smallest_power);
+    uint128 product = full_multiplication(w, pow5_table<void>::data[index]);
+    uint64_t const precision_mask = ~uint64_t(0) >> (mantissa_bits + 3);
+    if ((product.high & precision_mask) == precision_mask)
+    {
+        uint128 const second = full_multiplication(w, pow5_table<void>::data[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low)
+        {
+            ++product.high;
+        }
+    }
+
+    int const upperbit = int(product.high >> 63);
+    int const shift = upperbit + 64 - mantissa_bits - 3;
+    uint64_t m = product.high >> shift;
+    // floor(q * log2(10)) + 63
+    int power2 = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz - minimum_exponent;
+
+    if (power2 <= 0)
+    {
+        // subnormal
+        if (-power2 + 1 >= 64)
+        {
+            return 0;
+        }
+
+        m >>= -power2 + 1;
+        m += (m & 1);
+        m >>= 1;
+        power2 = (m < (uint64_t(1) << mantissa_bits)) ? 0 : 1;
+        return (uint64_t(power2) << mantissa_bits) | (m & ~(uint64_t(1) << mantissa_bits));
+    }
+
+    // Round to nearest, ties to even. A tie is only possible for small powers
+    // of ten, where the product is exact.
+    if (product.low <= 1 && q >= -4 && q <= 23 && (m & 3) == 1 && (m << shift) == product.high)
+    {
+        m &= ~uint64_t(1);
+    }
+
+    m += (m & 1);
+    m >>= 1;
+    if (m >= (uint64_t(2) << mantissa_bits))
+    {
+        m = uint64_t(1) << mantissa_bits;
+        ++power2;
+    }
+
+    m &= ~(uint64_t(1) << mantissa_bits);
+    if (power2 >= infinite_power)
+    {
+        return uint64_t(infinite_power) << mantissa_bits;
+    }
+
+    return (uint64_t(power2) << mantissa_bits) | m;
+}
+
+/**
+ * \brief Reads a floating point number from its text, the slow way
+ *
+ * The stream is imbued with the classic locale, so the decimal separator is
+ * always a period.
+ *
+ * \return false if the number is out of range
+ */
+template<class T, class Iterator>
+inline bool parse_float_slow(Iterator begin, Iterator end, T & result)
+{
+    std::istringstream ss(std::string(begin, end));
+    ss.imbue(std::locale::classic());
+    ss >> result;
+    return !ss.fail();
+}
+
+/**
+ * \brief Conversion of a decimal number into floating point type T
+ *
+ * Only double has a fast path. Other types are read with parse_float_slow.
+ * convert() returns false if the number is out of range.
+ */
+template<class T>
+struct float_converter
+{
+    template<class Iterator>
+    static bool convert(decimal_number const &, Iterator begin, Iterator end, T & result)
+    {
+        return parse_float_slow(begin, end, result);
+    }
+};
+
+template<>
+struct float_converter<double>
+{
+    template<class Iterator>
+    static bool convert(decimal_number const & num, Iterator begin, Iterator end, double & result)
+    {
+        if (clinger_fast_path(num, result))
+        {
+            return true;
+        }
+
+        uint64_t bits = eisel_lemire(num.mantissa, num.exponent);
+        if (num.truncated && bits != eisel_lemire(num.mantissa + 1, num.exponent))
+        {
+            // the dropped digits decide about the rounding
+            return parse_float_slow(begin, end, result);
+        }
+
+        if ((bits >> 52) == 0x7ff)
+        {
+            return false;
+        }
+
+        if (num.negative)
+        {
+            bits |= uint64_t(1) << 63;
+        }
+
+        std::memcpy(&result, &bits, sizeof(result));
+        return true;
+    }
+};
+
+/**
+ * \brief Adds a digit to the mantissa of a decimal number
+ *
+ * \return false if the mantissa is full and the digit was dropped
+ */
+inline bool add_digit(decimal_number & num, int & significant_digits, int digit)
+{
+    if (significant_digits < 19)
+    {
+        num.mantissa = num.mantissa * 10 + digit;
+        if (num.mantissa)
+        {
+            ++significant_digits;
+        }
+
+        return true;
+    }
+
+    num.truncated |= (digit != 0);
+    return false;
+}
+
+/**
+ * \brief Reports the floating point value of the number in [begin, end)
+ */
+template<class Iterator, class Handler>
+inline parse_error_code convert_float(decimal_number const & num, Iterator begin, Iterator end,
+                                      Handler & handler)
+{
+    typename Handler::float_type result;
+    if (!float_converter<typename Handler::float_type>::convert(num, begin, end, result))
+    {
+        return PARSE_NUMBER_OUT_OF_RANGE;
+    }
+
+    handler.on_float(result);
+    return PARSE_OK;
+}
+
+/**
+ * \brief Consumes a JSON number and reports it to a handler
+ *
+ * Integers that fit into the handler's int_type are passed to on_int,
+ * larger integers and numbers with a fractional part or exponent to
+ * on_float. Digits are accumulated while scanning, so no temporary copy of the
+ * number's text is made except on the rare slow path.
+ *
+ * \return PARSE_OK, or the reason the number is invalid. it is then left
+ * where the error was detected.
+ */
+template<class Iterator, class Handler>
+inline parse_error_code try_parse_number(Iterator & it, Iterator end, Handler & handler)
+{
+    typedef typename Handler::int_type int_type;
+
+    Iterator const number_begin = it;
+    decimal_number num = { 0, 0, false, false };
+    int significant_digits = 0;
+
+    if (*it == '+')
+    {
+        ++it;
+    }
+    else if (*it == '-')
+    {
+        num.negative = true;
+        ++it;
+    }
+
+    Iterator const digits_begin = it;
+    while (it != end && *it >= '0' && *it <= '9')
+    {
+        if (!add_digit(num, significant_digits, *it - '0'))
+        {
+            ++num.exponent;
+        }
+
+        ++it;
+    }
+
+    if (it != end && (*it == '.' || *it == 'e' || *it == 'E'))
+    {
+        // this is a floating point number
+        if (*it == '.')
+        {
+            ++it;
+            while (it != end && *it >= '0' && *it <= '9')
+            {
+                if (add_digit(num, significant_digits, *it - '0'))
+                {
+                    --num.exponent;
+                }
+
+                ++it;
+            }
+
+            if (it-1 == digits_begin)
+            {
+                // only a period, no digits
+                return PARSE_INVALID_DATA;
+            }
+        }
+
+        if (it != end && (*it == 'e' || *it == 'E'))
+        {
+            ++it;
+            if (it == end)
+            {
+                return PARSE_PREMATURE_END_IN_FLOAT;
+            }
+
+            bool exponent_negative = false;
+            if (*it == '+' || *it == '-')
+            {
+                exponent_negative = (*it == '-');
+                ++it;
+            }
+
+            if (it == end)
+            {
+                return PARSE_PREMATURE_END_IN_FLOAT;
+            }
+
+            if (*it < '0' || *it > '9')
+            {
+                return PARSE_INVALID_DATA;
+            }
+
+            int64_t exponent = 0;
+            while (it != end && *it >= '0' && *it <= '9')
+            {
+                // anything beyond this limit is zero or infinity anyway
+                if (exponent < 100000)
+                {
+                    exponent = exponent * 10 + (*it - '0');
+                }
+
+                ++it;
+            }
+
+            num.exponent += exponent_negative ? -exponent : exponent;
+        }
+
+        return convert_float(num, number_begin, it, handler);
+    }
+
+    if (it == digits_begin)
+    {
+        return PARSE_INVALID_DATA;
+    }
+
+    if (!num.truncated && num.exponent == 0)
+    {
+        uint64_t const max = static_cast<uint64_t>(std::numeric_limits<int_type>::max());
+        if (!num.negative && num.mantissa <= max)
+        {
+            handler.on_int(static_cast<int_type>(num.mantissa));
+            return PARSE_OK;
+        }
+
+        if (num.negative && num.mantissa == 0)
+        {
+            handler.on_int(int_type(0));
+            return PARSE_OK;
+        }
+
+        if (num.negative && std::numeric_limits<int_type>::is_signed && num.mantissa - 1 <= max)
+        {
+            handler.on_int(static_cast<int_type>(-static_cast<int_type>(num.mantissa - 1) - 1));
+            return PARSE_OK;
+        }
+    }
+
+    // integer does not fit into int_type
+    return convert_float(num, number_begin, it, handler);
+}
+
+template<class Iterator, class Handler>
+inline void parse_number(Iterator & it, Iterator end, Handler & handler)
+{
+    parse_error_code const code = try_parse_number(it, end, handler);
+    if (code)
+    {
+        throw_parser_error(code);
+    }
+}
+
+} // namespace impl
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_NUMPARSE_HPP__
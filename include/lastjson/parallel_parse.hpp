@@ -0,0 +1,409 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_PARALLEL_PARSE_HPP__
+#define LASTJSON_PARALLEL_PARSE_HPP__
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+#include "parse.hpp"
+#include "parse_options.hpp"
+#include "structural_index.hpp"
+#include "impl_helpers.hpp"
+#include "impl_threads.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Settings for parsing a large array on several threads
+ */
+struct parallel_options
+{
+    parallel_options()
+        : threads(0)
+        , chunk_size(1024 * 1024)
+    {
+    }
+
+    /// Number of threads, including the calling one, or 0 for one per hardware thread
+    std::size_t threads;
+
+    /// Approximate number of bytes of array elements parsed as one task
+    std::size_t chunk_size;
+
+    /// Settings for parsing the document
+    parse_options parse;
+};
+
+namespace impl {
+
+/**
+ * \brief A run of consecutive elements of a top-level array
+ */
+struct array_chunk
+{
+    std::size_t begin;          // offset of the first byte of the first element
+    std::size_t end;            // offset of the comma or bracket after the last element
+    std::size_t first_element;
+    std::size_t elements;
+};
+
+/**
+ * \brief Find the top-level elements of an array and cut them into chunks
+ *
+ * Only brackets and commas outside of strings are looked at, so this is
+ * much faster than parsing. The elements themselves are not validated.
+ *
+ * \param begin Pointer to the opening bracket of the array
+ * \param size Number of bytes from the opening bracket to the end of input
+ * \param chunk_size Approximate number of bytes per chunk
+ * \param chunks Vector the chunks get appended to
+ * \param close Set to the offset of the closing bracket
+ * \return false if the closing bracket was not found
+ */
+inline bool split_array(char const * begin, std::size_t size, std::size_t chunk_size,
+                        std::vector<array_chunk> & chunks, std::size_t & close,
+                        simd_level level = available_simd_level())
+{
+    block_classifier_function const classify = block_classifier(level);
+    string_tracker strings;
+    block_masks masks;
+    std::size_t depth = 0;
+    array_chunk chunk = { 1, 0, 0, 0 };
+    char tail[64];
+
+    for (std::size_t offset = 0; offset < size; offset += 64)
+    {
+        char const * block = begin + offset;
+        if (size - offset < 64)
+        {
+            // pad the last partial block with whitespace
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, size - offset);
+            block = tail;
+        }
+
+        classify(block, masks);
+        uint64_t quote;
+        uint64_t const inside = strings.next(masks, quote);
+
+        for (uint64_t bits = masks.op & ~inside; bits; bits &= bits - 1)
+        {
+            std::size_t const pos = offset + count_trailing_zeros(bits);
+            switch (begin[pos])
+            {
+            case '[': case '{':
+                ++depth;
+                break;
+
+            case ']': case '}':
+                if (--depth == 0)
+                {
+                    close = pos;
+                    chunk.end = pos;
+
+                    // the last element is followed by the bracket instead of
+                    // a comma, unless the array is empty
+                    char const * it = begin + chunk.begin;
+                    skipws(it, begin + pos);
+                    if (!chunks.empty() || chunk.elements || it != begin + pos)
+                    {
+                        ++chunk.elements;
+                    }
+
+                    chunks.push_back(chunk);
+                    return true;
+                }
+                break;
+
+            case ',':
+                if (depth == 1)
+                {
+                    ++chunk.elements;
+                    if (pos - chunk.begin >= chunk_size)
+                    {
+                        chunk.end = pos;
+                        chunks.push_back(chunk);
+                        chunk.begin = pos + 1;
+                        chunk.first_element += chunk.elements;
+                        chunk.elements = 0;
+                    }
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Parse the elements of one chunk into their slots of the array
+ */
+template<class Value>
+inline void parse_array_chunk(char const * begin, array_chunk const & chunk,
+                              typename Value::array_type & array, parse_options const & options)
+{
+    dom_builder<Value> builder;
+    event_parser<dom_builder<Value> > parser(builder, options);
+    char const * it = begin + chunk.begin;
+    char const * const end = begin + chunk.end;
+
+    for (std::size_t i = 0; i < chunk.elements; ++i)
+    {
+        if (i)
+        {
+            if (it == end || *it != ',')
+            {
+                throw parser_error("error parsing json array");
+            }
+
+            ++it;
+        }
+
+        skipws(it, end);
+        parser.parse_value(it, end);
+        skipws(it, end);
+        array[chunk.first_element + i].swap(builder.result());
+    }
+
+    if (it != end)
+    {
+        throw parser_error("error parsing json array");
+    }
+}
+
+/**
+ * \brief Parses the chunks of an array on several threads
+ *
+ * Every thread repeatedly takes the next chunk that nobody has started on.
+ * The first error stops all threads and is rethrown by run().
+ */
+template<class Value>
+class array_chunk_parser
+{
+public:
+    array_chunk_parser(char const * begin, std::vector<array_chunk> const & chunks,
+                       typename Value::array_type & array, parse_options const & options)
+        : m_begin(begin)
+        , m_chunks(chunks)
+        , m_array(array)
+        , m_options(options)
+        , m_next(0)
+        , m_failed(false)
+        , m_bad_alloc(false)
+    {
+    }
+
+    void run(std::size_t threads)
+    {
+        std::vector<shared_ptr<thread> > workers;
+        worker w = { this };
+
+        try
+        {
+            for (std::size_t i = 1; i < threads && i < m_chunks.size(); ++i)
+            {
+                workers.push_back(shared_ptr<thread>(new thread(w)));
+            }
+        }
+        catch (...)
+        {
+            fail("");
+            join(workers);
+            throw;
+        }
+
+        work();
+        join(workers);
+
+        if (m_bad_alloc)
+        {
+            throw std::bad_alloc();
+        }
+
+        if (m_failed)
+        {
+            throw parser_error(m_error);
+        }
+    }
+
+private:
+    struct worker
+    {
+        array_chunk_parser * parser;
+
+        void operator()()
+        {
+            parser->work();
+        }
+    };
+
+    char const * m_begin;
+    std::vector<array_chunk> const & m_chunks;
+    typename Value::array_type & m_array;
+    parse_options const & m_options;
+
+    mutex m_mutex;
+    std::size_t m_next;
+    bool m_failed;
+    bool m_bad_alloc;
+    std::string m_error;
+
+    static void join(std::vector<shared_ptr<thread> > & workers)
+    {
+        for (std::size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i]->join();
+        }
+    }
+
+    void fail(std::string const & error, bool bad_alloc = false)
+    {
+        unique_lock lock(m_mutex);
+        if (!m_failed)
+        {
+            m_failed = true;
+            m_bad_alloc = bad_alloc;
+            m_error = error;
+        }
+    }
+
+    void work()
+    {
+        while (true)
+        {
+            std::size_t n;
+            {
+                unique_lock lock(m_mutex);
+                if (m_failed || m_next == m_chunks.size())
+                {
+                    return;
+                }
+
+                n = m_next++;
+            }
+
+            try
+            {
+                parse_array_chunk<Value>(m_begin, m_chunks[n], m_array, m_options);
+            }
+            catch (std::bad_alloc const &)
+            {
+                fail("out of memory", true);
+            }
+            catch (std::exception const & e)
+            {
+                fail(e.what());
+            }
+        }
+    }
+};
+
+/**
+ * \brief Parse a document, using several threads if it is a large array
+ */
+template<class Value>
+inline Value parse_parallel(char const * begin, char const * end, parallel_options const & options)
+{
+    char const * it = begin;
+    skipws(it, end);
+
+    std::size_t const chunk_size = options.chunk_size ? options.chunk_size : 1;
+    std::vector<array_chunk> chunks;
+    std::size_t close = 0;
+    if (it == end || *it != '[' || options.parse.max_depth == 0
+        || std::size_t(end - it) < 2 * chunk_size
+        || !split_array(it, end - it, chunk_size, chunks, close)
+        || chunks.size() < 2)
+    {
+        return impl::parse<Value>(begin, end, options.parse);
+    }
+
+    check_utf8(begin, end, options.parse);
+
+    char const * rest = it + close + 1;
+    skipws(rest, end);
+    if (rest != end)
+    {
+        throw parser_error("additional data at the end of json data");
+    }
+
+    // the elements are one level deeper than the document
+    parse_options element_options = options.parse;
+    --element_options.max_depth;
+
+    typename Value::array_pointer array_ptr(
+        new typename Value::array_type(chunks.back().first_element + chunks.back().elements));
+    array_chunk_parser<Value>(it, chunks, *array_ptr, element_options).run(
+        options.threads ? options.threads : default_thread_count());
+
+    return Value(array_ptr);
+}
+
+} // namespace impl
+
+/**
+ * \brief Parse JSON data, splitting a large top-level array across threads
+ *
+ * A document that is an array of at least two chunks is cut at element
+ * boundaries by a quick scan over brackets, commas and strings. The chunks
+ * are then parsed concurrently straight into their slots of the result.
+ * Any other document is parsed like parse() does.
+ */
+template<class Value>
+inline Value parse_parallel(char const * begin, char const * end,
+                            parallel_options const & options = parallel_options())
+{
+    return impl::parse_parallel<Value>(begin, end, options);
+}
+
+template<class Value>
+inline Value parse_parallel(std::string const & str,
+                            parallel_options const & options = parallel_options())
+{
+    return impl::parse_parallel<Value>(str.data(), str.data() + str.size(), options);
+}
+
+inline value parse_parallel(char const * begin, char const * end,
+                            parallel_options const & options = parallel_options())
+{
+    return parse_parallel<value>(begin, end, options);
+}
+
+inline value parse_parallel(std::string const & str,
+                            parallel_options const & options = parallel_options())
+{
+    return parse_parallel<value>(str, options);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_PARALLEL_PARSE_HPP__
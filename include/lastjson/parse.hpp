@@ -23,325 +23,764 @@ THE SOFTWARE.
 #ifndef LASTJSON_PARSER_HPP__
 #define LASTJSON_PARSER_HPP__
 
-#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+#if __cplusplus >= 201703L
+# include <string_view>
+#endif
 
 #include "value.hpp"
 #include "stringrep.hpp"
 #include "impl_helpers.hpp"
+#include "sax.hpp"
+#include "parse_options.hpp"
+#include "parse_result.hpp"
 
 namespace lastjson {
 
 namespace impl {
 
-inline value parse_fragment(std::string::iterator & it, std::string::iterator end)
+/**
+ * \brief SAX handler that builds a basic_value
+ *
+ * Containers under construction are kept on an explicit stack, each with
+ * the key its next member will be stored under.
+ */
+template<class Value>
+class dom_builder
 {
-    if (it == end)
+public:
+    typedef typename Value::int_type int_type;
+    typedef typename Value::float_type float_type;
+
+    dom_builder()
+        : m_buffer_begin(0)
+        , m_buffer_end(0)
+    {
+    }
+
+    /**
+     * \brief Build values whose strings reference the given buffer
+     *
+     * Strings found within [begin, end) are not copied, but refer to the
+     * buffer, which the values then share ownership of.
+     */
+    dom_builder(shared_ptr<void const> const & buffer, char const * begin, char const * end)
+        : m_buffer(buffer)
+        , m_buffer_begin(begin)
+        , m_buffer_end(end)
     {
-        throw parser_error("premature end of json data");
     }
 
-    switch (*it)
+    /**
+     * \brief Let numbers keep their text, which is within buffer
+     *
+     * The text of a number that is a document of its own is copied, as what
+     * follows it in the buffer, if anything, need not end it.
+     */
+    void keep_number_text(shared_ptr<void const> const & buffer)
     {
-    case 'n':
-        ++it;
-        if (it != end && *it == 'u')
+        m_numbers = buffer;
+    }
+
+    void on_null()
+    {
+        Value v;
+        add(v);
+    }
+
+    void on_bool(bool b)
+    {
+        Value v = typename Value::bool_type(b);
+        add(v);
+    }
+
+    void on_int(int_type i)
+    {
+        if (m_numbers)
         {
-            ++it;
-            if (it != end && *it == 'l')
-            {
-                ++it;
-                if (it != end && *it == 'l')
-                {
-                    ++it;
-                    return value();
-                }
-            }
+            // added by on_number_text
+            m_number_is_int = true;
+            m_int = i;
+            return;
         }
 
-        throw parser_error("invalid json data");
+        Value v(i);
+        add(v);
+    }
 
-    case 'f':
-        ++it;
-        if (it != end && *it == 'a')
+    void on_float(float_type f)
+    {
+        if (m_numbers)
         {
-            ++it;
-            if (it != end && *it == 'l')
-            {
-                ++it;
-                if (it != end && *it == 's')
-                {
-                    ++it;
-                    if (it != end && *it == 'e')
-                    {
-                        ++it;
-                        return value(false);
-                    }
-                }
-            }
+            m_number_is_int = false;
+            m_float = f;
+            return;
         }
 
-        throw parser_error("invalid json data");
+        Value v(f);
+        add(v);
+    }
 
-    case 't':
-        ++it;
-        if (it != end && *it == 'r')
+    void on_number_text(char const * a, char const * b)
+    {
+        if (!m_numbers)
         {
-            ++it;
-            if (it != end && *it == 'u')
-            {
-                ++it;
-                if (it != end && *it == 'e')
-                {
-                    ++it;
-                    return value(true);
-                }
-            }
+            return;
         }
 
-        throw parser_error("invalid json data");
+        shared_ptr<void const> buffer = m_numbers;
+        if (m_stack.empty())
+        {
+            shared_ptr<std::string const> copy(new std::string(a, b));
+            a = copy->c_str();
+            buffer = copy;
+        }
 
-    case '"':
-    {
-        ++it;
-        std::string::iterator a, b;
-        unescape_string_inplace(it, end, a, b);
-        return value(a, b);
+        Value v = m_number_is_int ? Value(m_int, buffer, a) : Value(m_float, buffer, a);
+        add(v);
     }
 
-    case '[':
+    void on_string(char const * a, char const * b)
     {
-        ++it;
-        skipws(it, end);
-        if (it == end)
+        if (m_buffer && a >= m_buffer_begin && b <= m_buffer_end)
         {
-            throw parser_error("premature end of json data while parsing array");
+            Value v(m_buffer, a, b);
+            add(v);
+            return;
         }
 
-        value::array_pointer array_ptr(new value::array_type);
-        value::array_type & array = *array_ptr;
-        if (*it != ']')
+        typename Value::string_pointer string_ptr(new typename Value::string_type);
+        string_ptr->assign(a, b);
+        Value v(string_ptr);
+        add(v);
+    }
+
+    void on_key(char const * a, char const * b)
+    {
+        m_stack.back().key.assign(a, b);
+    }
+
+    void on_start_array()
+    {
+        typename Value::array_pointer array_ptr(new typename Value::array_type);
+        m_stack.push_back(frame());
+        frame & f = m_stack.back();
+        f.array = array_ptr.get();
+        f.container = Value(array_ptr);
+    }
+
+    void on_array_size(std::size_t size)
+    {
+        m_stack.back().array->reserve(size);
+    }
+
+    void on_end_array()
+    {
+        close_container();
+    }
+
+    void on_start_object()
+    {
+        typename Value::object_pointer object_ptr(new typename Value::object_type);
+        m_stack.push_back(frame());
+        frame & f = m_stack.back();
+        f.object = object_ptr.get();
+        f.container = Value(object_ptr);
+    }
+
+    void on_end_object()
+    {
+        close_container();
+    }
+
+    /**
+     * \brief The value built from the events received so far
+     */
+    Value & result()
+    {
+        return m_result;
+    }
+
+    void reset()
+    {
+        m_stack.clear();
+        m_result = Value();
+    }
+
+private:
+    struct frame
+    {
+        frame()
+            : array(0)
+            , object(0)
         {
-            while (true)
-            {
-                array.push_back(parse_fragment(it, end));
-                skipws(it, end);
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing array");
-                }
-
-                if (*it == ']')
-                {
-                    break;
-                }
-
-                if (*it != ',')
-                {
-                    throw parser_error("error parsing json array");
-                }
+        }
 
-                ++it;
-                skipws(it, end);
-            }
+        Value container;
+        typename Value::array_type * array;
+        typename Value::object_type * object;
+        typename Value::object_key_type key;
+    };
+
+    std::vector<frame> m_stack;
+    Value m_result;
+    shared_ptr<void const> m_buffer;
+    char const * m_buffer_begin;
+    char const * m_buffer_end;
+    shared_ptr<void const> m_numbers;
+    bool m_number_is_int;
+    int_type m_int;
+    float_type m_float;
+
+    void add(Value & v)
+    {
+        if (m_stack.empty())
+        {
+            m_result.swap(v);
+        }
+        else if (m_stack.back().array)
+        {
+            // swapped in rather than copied, which would touch reference counts
+            typename Value::array_type & array = *m_stack.back().array;
+            array.push_back(Value());
+            array.back().swap(v);
+        }
+        else
+        {
+            frame & f = m_stack.back();
+            (*f.object)[f.key].swap(v);
         }
+    }
+
+    void close_container()
+    {
+        Value container;
+        container.swap(m_stack.back().container);
+        m_stack.pop_back();
+        add(container);
+    }
+};
+
+template<class Value>
+inline void on_number_text(dom_builder<Value> & builder, char const * a, char const * b)
+{
+    builder.on_number_text(a, b);
+}
+
+template<class Value>
+inline void on_array_size(dom_builder<Value> & builder, std::size_t size)
+{
+    builder.on_array_size(size);
+}
+
+/**
+ * \brief SAX handler that overwrites an existing basic_value
+ *
+ * Arrays, objects and strings of the target that no other value shares are
+ * filled in place: array elements and object members are overwritten
+ * where they exist, and only what the new document lacks is removed. This
+ * keeps the containers' memory, the capacity of strings and the nodes of
+ * object members present in both documents.
+ */
+template<class Value>
+class reusing_builder
+{
+public:
+    typedef typename Value::int_type int_type;
+    typedef typename Value::float_type float_type;
+
+    explicit reusing_builder(Value & target)
+        : m_target(target)
+    {
+        // enough for typical documents to need no more allocations
+        m_stack.reserve(16);
+        m_members.reserve(64);
+    }
+
+    void on_null()
+    {
+        Value().swap(next_slot());
+    }
+
+    void on_bool(bool b)
+    {
+        Value(typename Value::bool_type(b)).swap(next_slot());
+    }
+
+    void on_int(int_type i)
+    {
+        Value(i).swap(next_slot());
+    }
 
-        ++it;
-        return value(array_ptr);
+    void on_float(float_type f)
+    {
+        Value(f).swap(next_slot());
     }
 
-    case '{':
+    void on_string(char const * a, char const * b)
     {
-        ++it;
-        skipws(it, end);
-        if (it == end)
+        Value & slot = next_slot();
+        if (slot.is_string() && slot.is_unique())
         {
-            throw parser_error("premature end of json data while parsing object");
+            slot.get_string_ref().assign(a, b);
+            return;
         }
 
-        value::object_pointer object_ptr(new value::object_type);
-        value::object_type & object = *object_ptr;
-        if (*it != '}')
+        typename Value::string_pointer string_ptr(new typename Value::string_type);
+        string_ptr->assign(a, b);
+        Value(string_ptr).swap(slot);
+    }
+
+    void on_key(char const * a, char const * b)
+    {
+        frame & f = m_stack.back();
+        m_key.assign(a, b);
+        f.member = &(*f.object)[m_key];
+        m_members.push_back(f.member);
+    }
+
+    void on_start_array()
+    {
+        Value & slot = next_slot();
+        if (!slot.is_array() || !slot.is_unique())
         {
-            while (true)
-            {
-                if (*it != '"')
-                {
-                    throw parser_error("error parsing json object");
-                }
+            Value(typename Value::array_pointer(new typename Value::array_type)).swap(slot);
+        }
 
-                ++it;
-                std::string::iterator key_a, key_b;
-                unescape_string_inplace(it, end, key_a, key_b);
-                skipws(it, end);
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing object");
-                }
-
-                if (*it != ':')
-                {
-                    throw parser_error("error parsing json object");
-                }
+        frame f;
+        f.array = &slot.get_array_ref();
+        m_stack.push_back(f);
+    }
 
-                ++it;
-                skipws(it, end);
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing object");
-                }
-
-                object[std::string(key_a, key_b)] = parse_fragment(it, end);
-                skipws(it, end);
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing object");
-                }
-
-                if (*it == '}')
-                {
-                    break;
-                }
-
-                if (*it != ',')
-                {
-                    throw parser_error("premature end of json data while parsing object");
-                }
+    void on_end_array()
+    {
+        frame const & f = m_stack.back();
+        f.array->erase(f.array->begin() + f.size, f.array->end());
+        m_stack.pop_back();
+    }
 
-                ++it;
-                skipws(it, end);
-            }
+    void on_start_object()
+    {
+        Value & slot = next_slot();
+        if (!slot.is_object() || !slot.is_unique())
+        {
+            Value(typename Value::object_pointer(new typename Value::object_type)).swap(slot);
         }
 
-        ++it;
-        return value(object_ptr);
+        frame f;
+        f.object = &slot.get_object_ref();
+        f.first_member = m_members.size();
+        m_stack.push_back(f);
     }
 
-    case '0': case '1': case '2': case '3': case '4':
-    case '5': case '6': case '7': case '8': case '9':
-    case '+': case '-': case '.':
+    void on_end_object()
     {
-        int sign = 1;
-        if (*it == '+')
+        frame const & f = m_stack.back();
+        remove_unset_members(*f.object, m_members.begin() + f.first_member, m_members.end());
+        m_members.resize(f.first_member);
+        m_stack.pop_back();
+    }
+
+private:
+    struct frame
+    {
+        frame()
+            : array(0)
+            , size(0)
+            , object(0)
+            , member(0)
+            , first_member(0)
         {
-            ++it;
         }
-        else if  (*it == '-')
+
+        typename Value::array_type * array;
+        std::size_t size;                   // elements set so far
+        typename Value::object_type * object;
+        Value * member;                     // member the next value goes to
+        std::size_t first_member;           // offset of this object's members in m_members
+    };
+
+    typedef typename std::vector<Value *>::iterator member_iterator;
+
+    Value & m_target;
+    std::vector<frame> m_stack;
+    std::vector<Value *> m_members;         // members set so far of all open objects
+    typename Value::object_key_type m_key;
+
+    Value & next_slot()
+    {
+        if (m_stack.empty())
+        {
+            return m_target;
+        }
+
+        frame & f = m_stack.back();
+        if (f.object)
         {
-            sign = -1;
-            ++it;
+            return *f.member;
         }
 
-        std::string::iterator const digits_begin = it;
-        while (it != end && *it >= '0' && *it <= '9')
+        if (f.size == f.array->size())
         {
-            ++it;
+            f.array->push_back(Value());
         }
 
-        if (it != end && (*it == '.' || *it == 'e' || *it == 'E'))
+        return (*f.array)[f.size++];
+    }
+
+    /**
+     * \brief Erase the members of an object that are not in [begin, end)
+     */
+    static void remove_unset_members(typename Value::object_type & object,
+                                     member_iterator begin, member_iterator end)
+    {
+        // a key may occur more than once in a document
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        if (std::size_t(end - begin) == object.size())
         {
-            // this is a floating point number
-            if (*it == '.')
+            return;
+        }
+
+        for (typename Value::object_type::iterator it = object.begin(); it != object.end(); )
+        {
+            if (std::binary_search(begin, end, &it->second))
             {
                 ++it;
-                while (it != end && *it >= '0' && *it <= '9')
-                {
-                    ++it;
-                }
-
-                if (it-1 == digits_begin)
-                {
-                    // only a period, no digits
-                    throw parser_error("invalid json data");
-                }
             }
-
-            if (it != end && (*it == 'e' || *it == 'E'))
+            else
             {
-                ++it;
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing float");
-                }
-
-                if (*it == '+' || *it == '-')
-                {
-                    ++it;
-                }
-
-                if (it == end)
-                {
-                    throw parser_error("premature end of json data while parsing float");
-                }
-
-                if (*it < '0' || *it > '9')
-                {
-                    throw parser_error("invalid json data");
-                }
-
-                ++it;
-                while (it != end && *it >= '0' && *it <= '9')
-                {
-                    ++it;
-                }
+                object.erase(it++);
             }
-
-            return value(sign * boost::lexical_cast<value::float_type>(std::string(digits_begin, it)));
         }
-        else
+    }
+};
+
+/**
+ * \brief Parse one JSON value and advance it past its end
+ */
+template<class Value>
+inline Value parse_fragment(char const * & it, char const * end,
+                            parse_options const & options = parse_options())
+{
+    dom_builder<Value> builder;
+    event_parser<dom_builder<Value> >(builder, options).parse_value(it, end);
+    return builder.result();
+}
+
+/**
+ * \brief Parse using the structural index engine
+ */
+template<class Value>
+inline Value parse_indexed(char const * begin, char const * end,
+                           simd_level level = available_simd_level(),
+                           parse_options const & options = parse_options())
+{
+    dom_builder<Value> builder;
+    parse_indexed(begin, end, builder, level, options);
+    return builder.result();
+}
+
+/**
+ * \brief Parse a complete JSON document, reporting errors by the result
+ *
+ * out is only assigned if the document is valid.
+ */
+template<class Value>
+inline parse_result try_parse(char const * begin, char const * end, Value & out,
+                              parse_options const & options = parse_options())
+{
+    try
+    {
+        dom_builder<Value> builder;
+        shared_ptr<std::string> copy;
+        if (options.raw_numbers)
         {
-            if (it == digits_begin)
-            {
-                throw parser_error("invalid json data");
-            }
+            // the text of numbers has to outlive the input
+            copy.reset(new std::string(begin, end));
+            begin = copy->data();
+            end = begin + copy->size();
+            builder.keep_number_text(copy);
+        }
 
-            return value(sign * boost::lexical_cast<value::int_type>(std::string(digits_begin, it)));
+        parse_result const result = try_parse_events(begin, end, builder, options);
+        if (result.ok())
+        {
+            out.swap(builder.result());
         }
+
+        return result;
     }
-    default:
-        break;
+    catch (std::bad_alloc const &)
+    {
+        return parse_result(PARSE_OUT_OF_MEMORY);
     }
+}
 
-    throw parser_error("invalid json data");
-};
-
-inline value parse(std::string::iterator begin, std::string::iterator end)
+/**
+ * \brief Parse a complete JSON document from a contiguous range of bytes
+ *
+ * The input is only read, never copied or modified.
+ */
+template<class Value>
+inline Value parse(char const * begin, char const * end,
+                   parse_options const & options = parse_options())
 {
-    value result = parse_fragment(begin, end);
-    skipws(begin, end);
-    if (begin != end)
+    Value result;
+    parse_result const r = impl::try_parse(begin, end, result, options);
+    if (!r.ok())
     {
-        std::cerr << "additional data: [[" << std::string(begin, end) << "]]" << std::endl;
-        throw parser_error("additional data at the end of json data");
+        throw_parser_error(r.code);
     }
 
     return result;
 }
 
+/**
+ * \brief Parse a complete JSON document, referencing strings in the input
+ */
+template<class Value>
+inline Value parse_shared(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                          parse_options const & options = parse_options())
+{
+    dom_builder<Value> builder(buffer, begin, end);
+    if (options.raw_numbers)
+    {
+        builder.keep_number_text(buffer);
+    }
+
+    parse_events(begin, end, builder, options);
+    return builder.result();
+}
+
 } // namespace impl
 
+/**
+ * \brief Parse JSON data into a value of the given basic_value type
+ *
+ * Use these overloads with an explicit template argument, e.g.
+ * lastjson::parse<my_value>(str), to parse into a basic_value with custom
+ * properties. The untemplated overloads return a lastjson::value.
+ */
+template<class Value>
+inline Value parse(char const * begin, char const * end)
+{
+    return impl::parse<Value>(begin, end);
+}
+
+template<class Value>
+inline Value parse(char const * data, std::size_t size)
+{
+    return impl::parse<Value>(data, data + size);
+}
+
+template<class Value>
+inline Value parse(char const * str)
+{
+    return impl::parse<Value>(str, str + std::strlen(str));
+}
+
+template<class Value>
+inline Value parse(std::string::const_iterator begin, std::string::const_iterator end)
+{
+    char const * const data = begin == end ? "" : &*begin;
+    return impl::parse<Value>(data, data + (end - begin));
+}
+
+template<class Value>
+inline Value parse(std::string const & str)
+{
+    return impl::parse<Value>(str.data(), str.data() + str.size());
+}
+
+#if __cplusplus >= 201703L
+template<class Value>
+inline Value parse(std::string_view str)
+{
+    return impl::parse<Value>(str.data(), str.data() + str.size());
+}
+#endif
+
+template<class Value>
+inline Value parse(char const * begin, char const * end, parse_options const & options)
+{
+    return impl::parse<Value>(begin, end, options);
+}
+
+template<class Value>
+inline Value parse(std::string const & str, parse_options const & options)
+{
+    return impl::parse<Value>(str.data(), str.data() + str.size(), options);
+}
+
+inline value parse(char const * begin, char const * end)
+{
+    return parse<value>(begin, end);
+}
+
+inline value parse(char const * data, std::size_t size)
+{
+    return parse<value>(data, size);
+}
+
+inline value parse(char const * str)
+{
+    return parse<value>(str);
+}
+
 inline value parse(std::string::const_iterator begin, std::string::const_iterator end)
 {
-    impl::skipws(begin, end);
-    std::string copy(begin, end);
-    std::string::iterator it = copy.begin();
-    return impl::parse(it, copy.end());
+    return parse<value>(begin, end);
 }
 
 inline value parse(std::string const & str)
 {
-    return parse(str.begin(), str.end());
+    return parse<value>(str);
+}
+
+#if __cplusplus >= 201703L
+inline value parse(std::string_view str)
+{
+    return parse<value>(str);
+}
+#endif
+
+inline value parse(char const * begin, char const * end, parse_options const & options)
+{
+    return parse<value>(begin, end, options);
+}
+
+inline value parse(std::string const & str, parse_options const & options)
+{
+    return parse<value>(str, options);
+}
+
+/**
+ * \brief Parse JSON data without throwing on invalid data
+ *
+ * Instead of a parser_error, or std::bad_alloc, the result tells why the
+ * data was rejected and at which byte offset. That makes rejecting invalid
+ * input about as cheap as accepting valid input. out keeps its previous
+ * value unless parsing succeeds. Exceptions thrown by the properties of a
+ * custom Value type are not caught.
+ */
+template<class Value>
+inline parse_result try_parse(char const * begin, char const * end, Value & out,
+                              parse_options const & options = parse_options())
+{
+    return impl::try_parse(begin, end, out, options);
+}
+
+template<class Value>
+inline parse_result try_parse(std::string const & str, Value & out,
+                              parse_options const & options = parse_options())
+{
+    return impl::try_parse(str.data(), str.data() + str.size(), out, options);
+}
+
+/**
+ * \brief Parse JSON data into an existing value, reusing its memory
+ *
+ * The result is the same as target = parse(...), but the strings, arrays
+ * and objects of target that are not shared with other values are
+ * overwritten in place rather than freed and allocated anew. When the same
+ * value is parsed into again and again from documents of a similar shape,
+ * hardly any memory is allocated. Strings are always copied, never
+ * references to the input as with parse_shared().
+ *
+ * If the data is invalid, a parser_error is thrown and target is left
+ * holding part of the new document.
+ */
+template<class Value>
+inline void parse_into(char const * begin, char const * end, Value & target,
+                       parse_options const & options = parse_options())
+{
+    impl::reusing_builder<Value> builder(target);
+    parse_result const result = impl::try_parse_events(begin, end, builder, options);
+    if (!result.ok())
+    {
+        impl::throw_parser_error(result.code);
+    }
+}
+
+template<class Value>
+inline void parse_into(std::string const & str, Value & target,
+                       parse_options const & options = parse_options())
+{
+    parse_into(str.data(), str.data() + str.size(), target, options);
+}
+
+template<class Value>
+inline Value parse_destructive(std::string::iterator begin, std::string::iterator end)
+{
+    char const * const data = begin == end ? "" : &*begin;
+    return impl::parse<Value>(data, data + (end - begin));
+}
+
+/**
+ * \brief Parse JSON data, letting string values reference the input buffer
+ *
+ * Strings without escape sequences are not copied into values of their
+ * own, but refer to their characters within [begin, end). The values share
+ * ownership of buffer, which must hold that range, so it lives as long as
+ * any string taken from it.
+ *
+ * Such a string is copied into a string_type object of its own when one is
+ * first asked for, e.g. by get_string(), even through a const reference.
+ * Copies of the value made before then do not share that object, and
+ * unlike other values, these must not be read from several threads at once.
+ */
+template<class Value>
+inline Value parse_shared(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                          parse_options const & options = parse_options())
+{
+    return impl::parse_shared<Value>(begin, end, buffer, options);
+}
+
+template<class Value>
+inline Value parse_shared(shared_ptr<std::string const> const & str,
+                          parse_options const & options = parse_options())
+{
+    return impl::parse_shared<Value>(str->data(), str->data() + str->size(), str, options);
+}
+
+inline value parse_shared(char const * begin, char const * end, shared_ptr<void const> const & buffer,
+                          parse_options const & options = parse_options())
+{
+    return parse_shared<value>(begin, end, buffer, options);
+}
+
+inline value parse_shared(shared_ptr<std::string const> const & str,
+                          parse_options const & options = parse_options())
+{
+    return parse_shared<value>(str, options);
+}
+
+/**
+ * \brief Parse JSON data, taking over the string holding it
+ *
+ * The string's contents are moved into a buffer that string values in the
+ * result reference, as with parse_shared().
+ */
+template<class Value>
+inline Value parse_destructive(std::string str, parse_options const & options = parse_options())
+{
+    shared_ptr<std::string> buffer(new std::string);
+    buffer->swap(str);
+    return impl::parse_shared<Value>(buffer->data(), buffer->data() + buffer->size(), buffer, options);
 }
 
 inline value parse_destructive(std::string::iterator begin, std::string::iterator end)
 {
-    impl::skipws(begin, end);
-    return impl::parse(begin, end);
+    return parse_destructive<value>(begin, end);
 }
 
-inline value parse_destructive(std::string str)
+inline value parse_destructive(std::string str, parse_options const & options = parse_options())
 {
-    std::string::iterator it = str.begin();
-    return parse_destructive(it, str.end());
+    return parse_destructive<value>(str, options);
 }
 
 } // namespace lastjson
@@ -0,0 +1,93 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_PARSE_OPTIONS_HPP__
+#define LASTJSON_PARSE_OPTIONS_HPP__
+
+#include <cstddef>
+
+namespace lastjson {
+
+/**
+ * \brief Settings for the parser
+ */
+struct parse_options
+{
+    enum { default_max_depth = 1024 };
+
+    parse_options()
+        : max_depth(default_max_depth)
+        , validate_utf8(false)
+        , raw_numbers(false)
+        , presize_arrays(false)
+    {
+    }
+
+    /**
+     * \brief Maximum nesting depth of arrays and objects
+     *
+     * Deeper input is rejected with a parser_error. The parser itself does
+     * not recurse, but destroying a value is recursive in its depth, so
+     * this should not be raised without care.
+     */
+    std::size_t max_depth;
+
+    /**
+     * \brief Reject input that is not well-formed UTF-8
+     *
+     * Otherwise bytes of strings are taken over as they are, and invalid
+     * sequences only cause a utf8_sequence_error when the string is
+     * escaped for output. The check is vectorised and costs a few percent
+     * of parsing throughput. It is done by the functions that parse a whole
+     * document in memory, not by push_parser, cursor or ndjson_parser.
+     */
+    bool validate_utf8;
+
+    /**
+     * \brief Keep the text of numbers for writing them out unchanged
+     *
+     * Numbers are still converted while parsing, but each value also refers
+     * to the number's text in the input, which write_json() copies instead
+     * of formatting the number anew. That is faster, and keeps all digits of
+     * floats, which are otherwise written with the precision of the stream.
+     * parse(), try_parse() and parse_file() make one copy of the input for
+     * this, while parse_shared() and parse_destructive() reference their
+     * buffer. Other parsers ignore this option.
+     */
+    bool raw_numbers;
+
+    /**
+     * \brief Reserve the memory of arrays before filling them
+     *
+     * The number of elements of every array is counted from the structural
+     * index before parsing, so that each array is allocated once instead of
+     * growing step by step. This pays off for documents with large arrays.
+     * It only applies to documents big enough for the structural index
+     * engine, and is ignored by the other parsers.
+     */
+    bool presize_arrays;
+};
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_PARSE_OPTIONS_HPP__
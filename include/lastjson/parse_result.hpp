@@ -0,0 +1,151 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_PARSE_RESULT_HPP__
+#define LASTJSON_PARSE_RESULT_HPP__
+
+#include <cstddef>
+
+namespace lastjson {
+
+/**
+ * \brief Reasons for JSON data to be rejected by the parser
+ */
+enum parse_error_code
+{
+    PARSE_OK = 0,
+    PARSE_PREMATURE_END,
+    PARSE_PREMATURE_END_IN_ARRAY,
+    PARSE_PREMATURE_END_IN_OBJECT,
+    PARSE_PREMATURE_END_IN_STRING,
+    PARSE_PREMATURE_END_IN_FLOAT,
+    PARSE_PREMATURE_END_IN_ESCAPE,
+    PARSE_INVALID_DATA,
+    PARSE_INVALID_ARRAY,
+    PARSE_INVALID_OBJECT,
+    PARSE_INVALID_ESCAPE,
+    PARSE_INVALID_UNICODE_ESCAPE,
+    PARSE_INVALID_SURROGATE,
+    PARSE_INVALID_UTF8,
+    PARSE_NUMBER_OUT_OF_RANGE,
+    PARSE_NESTED_TOO_DEEPLY,
+    PARSE_TRAILING_DATA,
+    PARSE_OUT_OF_MEMORY
+};
+
+/**
+ * \brief Convert a parse_error_code into the message of a parser_error
+ */
+inline char const * parse_error_message(parse_error_code code)
+{
+    switch (code)
+    {
+    case PARSE_OK:
+        return "no error";
+
+    case PARSE_PREMATURE_END:
+        return "premature end of json data";
+
+    case PARSE_PREMATURE_END_IN_ARRAY:
+        return "premature end of json data while parsing array";
+
+    case PARSE_PREMATURE_END_IN_OBJECT:
+        return "premature end of json data while parsing object";
+
+    case PARSE_PREMATURE_END_IN_STRING:
+        return "premature end of json data while parsing string";
+
+    case PARSE_PREMATURE_END_IN_FLOAT:
+        return "premature end of json data while parsing float";
+
+    case PARSE_PREMATURE_END_IN_ESCAPE:
+        return "premature end of json string";
+
+    case PARSE_INVALID_DATA:
+        return "invalid json data";
+
+    case PARSE_INVALID_ARRAY:
+        return "error parsing json array";
+
+    case PARSE_INVALID_OBJECT:
+        return "error parsing json object";
+
+    case PARSE_INVALID_ESCAPE:
+        return "error while parsing backslash escape sequence";
+
+    case PARSE_INVALID_UNICODE_ESCAPE:
+        return "error decoding unicode escape sequence";
+
+    case PARSE_INVALID_SURROGATE:
+        return "error decoding surrogate unicode escape sequence";
+
+    case PARSE_INVALID_UTF8:
+        return "invalid utf-8 sequence in json data";
+
+    case PARSE_NUMBER_OUT_OF_RANGE:
+        return "number out of range";
+
+    case PARSE_NESTED_TOO_DEEPLY:
+        return "json data nested too deeply";
+
+    case PARSE_TRAILING_DATA:
+        return "additional data at the end of json data";
+
+    case PARSE_OUT_OF_MEMORY:
+        return "out of memory";
+    }
+
+    return "(unknown)";
+}
+
+/**
+ * \brief Outcome of parsing without exceptions
+ */
+struct parse_result
+{
+    parse_result(parse_error_code code = PARSE_OK, std::size_t offset = 0)
+        : code(code)
+        , offset(offset)
+    {
+    }
+
+    /// PARSE_OK, or why the data was rejected
+    parse_error_code code;
+
+    /// Offset of the byte in the input at which the error was detected
+    std::size_t offset;
+
+    bool ok() const
+    {
+        return code == PARSE_OK;
+    }
+
+    char const * message() const
+    {
+        return parse_error_message(code);
+    }
+};
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_PARSE_RESULT_HPP__
@@ -0,0 +1,595 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_PROJECTION_HPP__
+#define LASTJSON_PROJECTION_HPP__
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "value.hpp"
+#include "parse.hpp"
+#include "parse_options.hpp"
+#include "sax.hpp"
+#include "impl_helpers.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief A compiled set of JSON Pointer paths to extract from documents
+ *
+ * Paths are JSON Pointers (RFC 6901), such as "/user/id" or "/items/0/price".
+ * A segment consisting of a single asterisk stands for every member of an
+ * object or element of an array. The empty path selects the whole document.
+ * A projection is compiled once and can then be used for any number of
+ * documents, also from several threads at once.
+ */
+class projection
+{
+public:
+    projection()
+    {
+        compile();
+    }
+
+    explicit projection(std::vector<std::string> const & pointers)
+    {
+        for (std::vector<std::string>::const_iterator it = pointers.begin(); it != pointers.end(); ++it)
+        {
+            m_paths.push_back(split(*it));
+        }
+
+        compile();
+    }
+
+    /**
+     * \brief Add a path to the projection
+     *
+     * \throw parser_error if pointer is not a valid JSON Pointer
+     */
+    void add(std::string const & pointer)
+    {
+        m_paths.push_back(split(pointer));
+        compile();
+    }
+
+    /// Index of the node for the value a path starts from
+    enum { root = 0 };
+
+    /// Node index standing for "not selected", as no node leads back to the root
+    enum { none = 0 };
+
+    /**
+     * \brief Whether the value at a node is selected as a whole
+     */
+    bool whole(std::size_t node) const
+    {
+        return m_nodes[node].whole;
+    }
+
+    /**
+     * \brief Node for the member [a, b) of an object at the given node
+     */
+    std::size_t member(std::size_t node, char const * a, char const * b) const
+    {
+        node_type const & n = m_nodes[node];
+        std::size_t const size = b - a;
+        for (std::vector<child>::const_iterator it = n.members.begin(); it != n.members.end(); ++it)
+        {
+            if (it->first.size() == size && std::memcmp(it->first.data(), a, size) == 0)
+            {
+                return it->second;
+            }
+        }
+
+        return n.any;
+    }
+
+    /**
+     * \brief Node for the element at index i of an array at the given node
+     */
+    std::size_t element(std::size_t node, std::size_t i) const
+    {
+        node_type const & n = m_nodes[node];
+        for (std::vector<std::pair<std::size_t, std::size_t> >::const_iterator it = n.elements.begin();
+             it != n.elements.end(); ++it)
+        {
+            if (it->first == i)
+            {
+                return it->second;
+            }
+        }
+
+        return n.any;
+    }
+
+private:
+    typedef std::vector<std::string> path;
+    typedef std::pair<std::string, std::size_t> child;
+
+    struct node_type
+    {
+        node_type()
+            : whole(false)
+            , any(none)
+        {
+        }
+
+        bool whole;
+        std::vector<child> members;
+        std::vector<std::pair<std::size_t, std::size_t> > elements;
+        std::size_t any;
+    };
+
+    std::vector<path> m_paths;
+    std::vector<node_type> m_nodes;
+
+    static path split(std::string const & pointer)
+    {
+        path segments;
+        if (pointer.empty())
+        {
+            return segments;
+        }
+
+        if (pointer[0] != '/')
+        {
+            throw parser_error("invalid json pointer: " + pointer);
+        }
+
+        std::string segment;
+        for (std::string::const_iterator it = pointer.begin() + 1; ; ++it)
+        {
+            if (it == pointer.end() || *it == '/')
+            {
+                segments.push_back(segment);
+                segment.clear();
+                if (it == pointer.end())
+                {
+                    break;
+                }
+            }
+            else if (*it == '~')
+            {
+                ++it;
+                if (it == pointer.end() || (*it != '0' && *it != '1'))
+                {
+                    throw parser_error("invalid json pointer: " + pointer);
+                }
+
+                segment += *it == '0' ? '~' : '/';
+            }
+            else
+            {
+                segment += *it;
+            }
+        }
+
+        return segments;
+    }
+
+    /**
+     * \brief Parse an array index segment, returning false if it is none
+     */
+    static bool index(std::string const & segment, std::size_t & i)
+    {
+        if (segment.empty() || segment.size() > 18 || (segment[0] == '0' && segment.size() > 1))
+        {
+            return false;
+        }
+
+        i = 0;
+        for (std::string::const_iterator it = segment.begin(); it != segment.end(); ++it)
+        {
+            if (*it < '0' || *it > '9')
+            {
+                return false;
+            }
+
+            i = i * 10 + (*it - '0');
+        }
+
+        return true;
+    }
+
+    void compile()
+    {
+        m_nodes.clear();
+        std::vector<std::pair<path const *, std::size_t> > suffixes;
+        for (std::vector<path>::const_iterator it = m_paths.begin(); it != m_paths.end(); ++it)
+        {
+            suffixes.push_back(std::make_pair(&*it, std::size_t(0)));
+        }
+
+        build(suffixes);
+    }
+
+    /**
+     * \brief Build the node matching the given path suffixes, returning its index
+     *
+     * The child for a named segment also carries the paths continuing from
+     * a "*" segment, so matching a member or element never has to follow
+     * more than one child.
+     */
+    std::size_t build(std::vector<std::pair<path const *, std::size_t> > const & suffixes)
+    {
+        std::size_t const index = m_nodes.size();
+        m_nodes.push_back(node_type());
+
+        std::vector<std::pair<path const *, std::size_t> > any;
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < suffixes.size(); ++i)
+        {
+            path const & p = *suffixes[i].first;
+            std::size_t const at = suffixes[i].second;
+            if (at == p.size())
+            {
+                m_nodes[index].whole = true;
+                return index;
+            }
+            else if (p[at] == "*")
+            {
+                any.push_back(std::make_pair(&p, at + 1));
+            }
+            else if (std::find(names.begin(), names.end(), p[at]) == names.end())
+            {
+                names.push_back(p[at]);
+            }
+        }
+
+        for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name)
+        {
+            std::vector<std::pair<path const *, std::size_t> > next(any);
+            for (std::size_t i = 0; i < suffixes.size(); ++i)
+            {
+                path const & p = *suffixes[i].first;
+                if (p[suffixes[i].second] == *name)
+                {
+                    next.push_back(std::make_pair(&p, suffixes[i].second + 1));
+                }
+            }
+
+            std::size_t const c = build(next);
+            m_nodes[index].members.push_back(child(*name, c));
+
+            std::size_t i;
+            if (projection::index(*name, i))
+            {
+                m_nodes[index].elements.push_back(std::make_pair(i, c));
+            }
+        }
+
+        if (!any.empty())
+        {
+            std::size_t const c = build(any);
+            m_nodes[index].any = c;
+        }
+
+        return index;
+    }
+};
+
+namespace impl {
+
+/**
+ * \brief Parser building only the parts of a document a projection selects
+ *
+ * Containers on a selected path are walked here, and selected values are
+ * parsed in full. Everything else is skipped without being built.
+ */
+template<class Value>
+class projecting_parser
+{
+public:
+    projecting_parser(projection const & paths, parse_options const & options)
+        : m_paths(paths)
+        , m_options(options)
+        , m_events(m_builder, options)
+    {
+    }
+
+    /**
+     * \brief Parse the value at it, returning whether anything in it was selected
+     */
+    bool parse_value(char const * & it, char const * end, std::size_t node, std::size_t depth,
+                     Value & result)
+    {
+        skipws(it, end);
+        if (it == end)
+        {
+            throw parser_error("premature end of json data");
+        }
+
+        if (m_paths.whole(node))
+        {
+            if (*it == '[' || *it == '{')
+            {
+                parse_options options = m_options;
+                options.max_depth -= depth;
+                parse_fragment<Value>(it, end, options).swap(result);
+            }
+            else
+            {
+                m_events.parse_value(it, end);
+                result.swap(m_builder.result());
+            }
+
+            return true;
+        }
+
+        if (*it == '[' || *it == '{')
+        {
+            if (depth >= m_options.max_depth)
+            {
+                throw parser_error("json data nested too deeply");
+            }
+
+            return *it == '[' ? parse_array(it, end, node, depth, result)
+                              : parse_object(it, end, node, depth, result);
+        }
+
+        skip_value(it, end, 0);
+        return false;
+    }
+
+private:
+    projection const & m_paths;
+    parse_options m_options;
+    dom_builder<Value> m_builder;
+    event_parser<dom_builder<Value> > m_events;
+
+    bool parse_array(char const * & it, char const * end, std::size_t node, std::size_t depth,
+                     Value & result)
+    {
+        typename Value::array_pointer array_ptr;
+        ++it;
+        skipws(it, end);
+        if (it != end && *it == ']')
+        {
+            ++it;
+            return false;
+        }
+
+        for (std::size_t i = 0; ; ++i)
+        {
+            std::size_t const child = m_paths.element(node, i);
+            if (child == projection::none)
+            {
+                skip_value(it, end, m_options.max_depth - depth - 1);
+            }
+            else
+            {
+                Value v;
+                if (parse_value(it, end, child, depth + 1, v))
+                {
+                    if (!array_ptr)
+                    {
+                        array_ptr.reset(new typename Value::array_type);
+                    }
+
+                    // unselected elements before a selected one become null
+                    array_ptr->resize(i + 1);
+                    array_ptr->back().swap(v);
+                }
+            }
+
+            skipws(it, end);
+            if (it == end)
+            {
+                throw parser_error("premature end of json data while parsing array");
+            }
+
+            char const c = *(it++);
+            if (c == ']')
+            {
+                break;
+            }
+            else if (c != ',')
+            {
+                throw parser_error("error parsing json array");
+            }
+        }
+
+        if (!array_ptr)
+        {
+            return false;
+        }
+
+        Value(array_ptr).swap(result);
+        return true;
+    }
+
+    bool parse_object(char const * & it, char const * end, std::size_t node, std::size_t depth,
+                      Value & result)
+    {
+        typename Value::object_pointer object_ptr;
+        ++it;
+        skipws(it, end);
+        if (it != end && *it == '}')
+        {
+            ++it;
+            return false;
+        }
+
+        for (;;)
+        {
+            skipws(it, end);
+            if (it == end)
+            {
+                throw parser_error("premature end of json data while parsing object");
+            }
+            if (*it != '"')
+            {
+                throw parser_error("error parsing json object");
+            }
+
+            char const * a;
+            char const * b;
+            ++it;
+            m_events.read_string(it, end, a, b);
+            std::size_t const child = m_paths.member(node, a, b);
+            typename Value::object_key_type key;
+            if (child != projection::none)
+            {
+                key.assign(a, b);
+            }
+
+            skipws(it, end);
+            if (it == end)
+            {
+                throw parser_error("premature end of json data while parsing object");
+            }
+            if (*(it++) != ':')
+            {
+                throw parser_error("error parsing json object");
+            }
+
+            if (child == projection::none)
+            {
+                skip_value(it, end, m_options.max_depth - depth - 1);
+            }
+            else
+            {
+                Value v;
+                if (parse_value(it, end, child, depth + 1, v))
+                {
+                    if (!object_ptr)
+                    {
+                        object_ptr.reset(new typename Value::object_type);
+                    }
+
+                    (*object_ptr)[key].swap(v);
+                }
+            }
+
+            skipws(it, end);
+            if (it == end)
+            {
+                throw parser_error("premature end of json data while parsing object");
+            }
+
+            char const c = *(it++);
+            if (c == '}')
+            {
+                break;
+            }
+            else if (c != ',')
+            {
+                throw parser_error("error parsing json object");
+            }
+        }
+
+        if (!object_ptr)
+        {
+            return false;
+        }
+
+        Value(object_ptr).swap(result);
+        return true;
+    }
+};
+
+template<class Value>
+inline Value parse_projected(char const * begin, char const * end, projection const & paths,
+                             parse_options const & options)
+{
+    check_utf8(begin, end, options);
+
+    Value result;
+    projecting_parser<Value>(paths, options).parse_value(begin, end, projection::root, 0, result);
+
+    skipws(begin, end);
+    if (begin != end)
+    {
+        throw parser_error("additional data at the end of json data");
+    }
+
+    return result;
+}
+
+} // namespace impl
+
+/**
+ * \brief Parse only the parts of JSON data selected by a projection
+ *
+ * The result holds the selected values at their places in the document.
+ * Objects keep only the members on a selected path, and arrays end after
+ * their last selected element, with null in place of elements that were
+ * not selected. Containers with nothing selected in them are left out, and
+ * the result is null if nothing was selected at all.
+ *
+ * All other values are skipped without building anything. Arrays and
+ * objects that are skipped are only scanned for their closing bracket, so
+ * errors within them may go unnoticed.
+ */
+template<class Value>
+inline Value parse_projected(char const * begin, char const * end, projection const & paths,
+                             parse_options const & options = parse_options())
+{
+    return impl::parse_projected<Value>(begin, end, paths, options);
+}
+
+template<class Value>
+inline Value parse_projected(std::string const & str, projection const & paths,
+                             parse_options const & options = parse_options())
+{
+    return impl::parse_projected<Value>(str.data(), str.data() + str.size(), paths, options);
+}
+
+/**
+ * \brief Parse only the parts of JSON data at the given JSON Pointer paths
+ *
+ * This compiles a projection for a single use. Construct a projection once
+ * to extract the same paths from many documents.
+ */
+template<class Value>
+inline Value parse_projected(std::string const & str, std::vector<std::string> const & pointers,
+                             parse_options const & options = parse_options())
+{
+    return parse_projected<Value>(str, projection(pointers), options);
+}
+
+inline value parse_projected(char const * begin, char const * end, projection const & paths,
+                             parse_options const & options = parse_options())
+{
+    return parse_projected<value>(begin, end, paths, options);
+}
+
+inline value parse_projected(std::string const & str, projection const & paths,
+                             parse_options const & options = parse_options())
+{
+    return parse_projected<value>(str, paths, options);
+}
+
+inline value parse_projected(std::string const & str, std::vector<std::string> const & pointers,
+                             parse_options const & options = parse_options())
+{
+    return parse_projected<value>(str, pointers, options);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_PROJECTION_HPP__
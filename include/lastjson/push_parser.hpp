@@ -0,0 +1,555 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+#ifndef LASTJSON_PUSH_PARSER_HPP__
+#define LASTJSON_PUSH_PARSER_HPP__
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "value.hpp"
+#include "parse.hpp"
+#include "impl_helpers.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Incremental JSON parser that accepts its input in chunks
+ *
+ * Data is passed in with feed() in pieces of arbitrary size, e.g. as it
+ * arrives from a socket. Nesting is tracked on an explicit stack, and a token
+ * (string, number or literal) that is cut by the end of a chunk is set aside
+ * and completed with the following chunk. Tokens that lie entirely within
+ * one chunk are decoded straight from the caller's buffer.
+ *
+ * Once all data has been fed, finish() returns the parsed value and resets
+ * the parser for the next document. If feed() or finish() throw a
+ * parser_error, the parser must be reset() before it can be used again.
+ */
+template<class Value>
+class basic_push_parser
+{
+public:
+    typedef Value value_type;
+
+    explicit basic_push_parser(parse_options const & options = parse_options())
+        : m_max_depth(options.max_depth)
+    {
+        reset();
+    }
+
+    /**
+     * \brief Discard all state and get ready for a new document
+     */
+    void reset()
+    {
+        m_stack.clear();
+        m_state = EXPECT_VALUE;
+        m_token_type = NO_TOKEN;
+        m_token.clear();
+        m_escape = false;
+        m_builder.reset();
+    }
+
+    /**
+     * \brief Parse the next chunk of JSON data
+     *
+     * \param data Pointer to the chunk
+     * \param size Size of the chunk in bytes
+     */
+    void feed(char const * data, std::size_t size)
+    {
+        if (m_state == FAILED)
+        {
+            throw parser_error("push parser used after error");
+        }
+
+        char const * it = data;
+        char const * const end = data + size;
+
+        if (m_token_type != NO_TOKEN && !continue_token(it, end))
+        {
+            return;
+        }
+
+        while (true)
+        {
+            impl::skipws(it, end);
+            if (it == end)
+            {
+                return;
+            }
+
+            char const c = *it;
+            switch (m_state)
+            {
+            case EXPECT_VALUE:
+            case ARRAY_FIRST:
+                if (m_state == ARRAY_FIRST && c == ']')
+                {
+                    ++it;
+                    close_container();
+                    break;
+                }
+
+                switch (c)
+                {
+                case '[':
+                    ++it;
+                    open_container(ARRAY);
+                    break;
+                case '{':
+                    ++it;
+                    open_container(OBJECT);
+                    break;
+                case '"':
+                    ++it;
+                    if (!start_string(STRING_TOKEN, it, end))
+                    {
+                        return;
+                    }
+                    break;
+                case 'n': case 't': case 'f':
+                    if (!start_run(LITERAL_TOKEN, it, end))
+                    {
+                        return;
+                    }
+                    break;
+                case '0': case '1': case '2': case '3': case '4':
+                case '5': case '6': case '7': case '8': case '9':
+                case '+': case '-': case '.':
+                    if (!start_run(NUMBER_TOKEN, it, end))
+                    {
+                        return;
+                    }
+                    break;
+                default:
+                    fail("invalid json data");
+                }
+                break;
+
+            case ARRAY_NEXT:
+                ++it;
+                if (c == ']')
+                {
+                    close_container();
+                }
+                else if (c == ',')
+                {
+                    m_state = EXPECT_VALUE;
+                }
+                else
+                {
+                    fail("error parsing json array");
+                }
+                break;
+
+            case OBJECT_FIRST:
+            case OBJECT_KEY:
+                ++it;
+                if (m_state == OBJECT_FIRST && c == '}')
+                {
+                    close_container();
+                }
+                else if (c != '"')
+                {
+                    fail("error parsing json object");
+                }
+                else if (!start_string(KEY_TOKEN, it, end))
+                {
+                    return;
+                }
+                break;
+
+            case OBJECT_COLON:
+                ++it;
+                if (c != ':')
+                {
+                    fail("error parsing json object");
+                }
+
+                m_state = EXPECT_VALUE;
+                break;
+
+            case OBJECT_NEXT:
+                ++it;
+                if (c == '}')
+                {
+                    close_container();
+                }
+                else if (c == ',')
+                {
+                    m_state = OBJECT_KEY;
+                }
+                else
+                {
+                    fail("error parsing json object");
+                }
+                break;
+
+            case DONE:
+                fail("additional data at the end of json data");
+
+            case FAILED:
+                return;
+            }
+        }
+    }
+
+    /**
+     * \brief Parse the next chunk of JSON data
+     */
+    void feed(std::string const & data)
+    {
+        feed(data.data(), data.size());
+    }
+
+    /**
+     * \brief Signal the end of the input and return the parsed value
+     *
+     * Throws if the data fed so far is not a complete JSON document. On
+     * success the parser is reset and can be fed the next document.
+     */
+    Value finish()
+    {
+        if (m_state == FAILED)
+        {
+            throw parser_error("push parser used after error");
+        }
+
+        if (m_token_type == STRING_TOKEN || m_token_type == KEY_TOKEN)
+        {
+            fail("premature end of json data while parsing string");
+        }
+
+        if (m_token_type != NO_TOKEN)
+        {
+            complete_run(m_token_type, m_token.data(), m_token.data() + m_token.size());
+        }
+
+        if (m_state != DONE)
+        {
+            fail("premature end of json data");
+        }
+
+        Value result;
+        result.swap(m_builder.result());
+        reset();
+        return result;
+    }
+
+    /**
+     * \brief Current nesting depth of arrays and objects
+     */
+    std::size_t depth() const
+    {
+        return m_stack.size();
+    }
+
+private:
+    enum parser_state
+    {
+        EXPECT_VALUE,   // a value must follow
+        ARRAY_FIRST,    // after '[': a value or ']'
+        ARRAY_NEXT,     // after an array member: ',' or ']'
+        OBJECT_FIRST,   // after '{': a key or '}'
+        OBJECT_KEY,     // after ',' in an object: a key
+        OBJECT_COLON,   // after a key: ':'
+        OBJECT_NEXT,    // after an object member: ',' or '}'
+        DONE,           // the document is complete
+        FAILED          // a parser error has been thrown
+    };
+
+    enum token_type
+    {
+        NO_TOKEN,
+        STRING_TOKEN,
+        KEY_TOKEN,
+        NUMBER_TOKEN,
+        LITERAL_TOKEN
+    };
+
+    impl::dom_builder<Value> m_builder;
+    std::size_t m_max_depth;
+    std::vector<jsontype> m_stack;  // ARRAY or OBJECT for every open container
+    parser_state m_state;
+    token_type m_token_type;
+    std::string m_token;    // the part of a token seen so far
+    bool m_escape;          // m_token ends with an unescaped backslash
+    std::string m_buffer;   // for unescaping strings
+
+    void fail(char const * message)
+    {
+        m_state = FAILED;
+        throw parser_error(message);
+    }
+
+    static bool is_run_char(token_type type, char c)
+    {
+        if (type == NUMBER_TOKEN)
+        {
+            return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E';
+        }
+
+        return c >= 'a' && c <= 'z';
+    }
+
+    void open_container(jsontype type)
+    {
+        if (m_stack.size() >= m_max_depth)
+        {
+            fail("json data nested too deeply");
+        }
+
+        m_stack.push_back(type);
+        if (type == ARRAY)
+        {
+            m_builder.on_start_array();
+            m_state = ARRAY_FIRST;
+        }
+        else
+        {
+            m_builder.on_start_object();
+            m_state = OBJECT_FIRST;
+        }
+    }
+
+    void close_container()
+    {
+        if (m_stack.back() == ARRAY)
+        {
+            m_builder.on_end_array();
+        }
+        else
+        {
+            m_builder.on_end_object();
+        }
+
+        m_stack.pop_back();
+        value_complete();
+    }
+
+    void value_complete()
+    {
+        if (m_stack.empty())
+        {
+            m_state = DONE;
+        }
+        else if (m_stack.back() == ARRAY)
+        {
+            m_state = ARRAY_NEXT;
+        }
+        else
+        {
+            m_state = OBJECT_NEXT;
+        }
+    }
+
+    /**
+     * \brief Finds the closing quote of a string, honouring backslash escapes
+     *
+     * \return Pointer to the closing quote, or end if there is none
+     */
+    char const * find_closing_quote(char const * it, char const * end)
+    {
+        while (it != end)
+        {
+            if (m_escape)
+            {
+                m_escape = false;
+                ++it;
+                continue;
+            }
+
+            it = impl::find_quote_or_backslash(it, end);
+            if (it == end)
+            {
+                break;
+            }
+
+            if (*it == '"')
+            {
+                return it;
+            }
+
+            m_escape = true;
+            ++it;
+        }
+
+        return end;
+    }
+
+    /**
+     * \brief Report a string, given from after its opening quote to after its closing quote
+     */
+    void string_complete(token_type type, char const * a, char const * end)
+    {
+        char const * b = end - 1;
+        if (std::memchr(a, '\\', b - a))
+        {
+            m_buffer.clear();
+            impl::unescape_string(a, end, m_buffer);
+            a = m_buffer.data();
+            b = a + m_buffer.size();
+        }
+
+        if (type == KEY_TOKEN)
+        {
+            m_builder.on_key(a, b);
+            m_state = OBJECT_COLON;
+        }
+        else
+        {
+            m_builder.on_string(a, b);
+            value_complete();
+        }
+    }
+
+    /**
+     * \brief Handle a string whose opening quote has just been consumed
+     *
+     * \return false if the string continues beyond the end of this chunk
+     */
+    bool start_string(token_type type, char const * & it, char const * end)
+    {
+        m_escape = false;
+        char const * const quote = find_closing_quote(it, end);
+        if (quote == end)
+        {
+            m_token.assign(it, end);
+            m_token_type = type;
+            return false;
+        }
+
+        char const * const a = it;
+        it = quote + 1;
+        string_complete(type, a, it);
+        return true;
+    }
+
+    /**
+     * \brief Handle a number or literal starting at it
+     *
+     * \return false if the token may continue beyond the end of this chunk
+     */
+    bool start_run(token_type type, char const * & it, char const * end)
+    {
+        char const * const a = it;
+        while (it != end && is_run_char(type, *it))
+        {
+            ++it;
+        }
+
+        if (it == end)
+        {
+            m_token.assign(a, end);
+            m_token_type = type;
+            return false;
+        }
+
+        complete_run(type, a, it);
+        return true;
+    }
+
+    void complete_run(token_type type, char const * a, char const * b)
+    {
+        char const * it = a;
+
+        if (type == NUMBER_TOKEN)
+        {
+            impl::parse_number(it, b, m_builder);
+        }
+        else if (b - a == 4 && std::memcmp(a, "null", 4) == 0)
+        {
+            m_builder.on_null();
+            it = b;
+        }
+        else if (b - a == 4 && std::memcmp(a, "true", 4) == 0)
+        {
+            m_builder.on_bool(true);
+            it = b;
+        }
+        else if (b - a == 5 && std::memcmp(a, "false", 5) == 0)
+        {
+            m_builder.on_bool(false);
+            it = b;
+        }
+
+        if (it != b)
+        {
+            fail("invalid json data");
+        }
+
+        m_token_type = NO_TOKEN;
+        m_token.clear();
+        value_complete();
+    }
+
+    /**
+     * \brief Continue a token cut by the end of the previous chunk
+     *
+     * \return false if the token still continues beyond this chunk
+     */
+    bool continue_token(char const * & it, char const * end)
+    {
+        if (m_token_type == STRING_TOKEN || m_token_type == KEY_TOKEN)
+        {
+            char const * const quote = find_closing_quote(it, end);
+            if (quote == end)
+            {
+                m_token.append(it, end);
+                return false;
+            }
+
+            m_token.append(it, quote + 1);
+            it = quote + 1;
+            token_type const type = m_token_type;
+            m_token_type = NO_TOKEN;
+            string_complete(type, m_token.data(), m_token.data() + m_token.size());
+            m_token.clear();
+            return true;
+        }
+
+        char const * const a = it;
+        while (it != end && is_run_char(m_token_type, *it))
+        {
+            ++it;
+        }
+
+        m_token.append(a, it);
+        if (it == end)
+        {
+            return false;
+        }
+
+        complete_run(m_token_type, m_token.data(), m_token.data() + m_token.size());
+        return true;
+    }
+};
+
+typedef basic_push_parser<value> push_parser;
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_PUSH_PARSER_HPP__
@@ -0,0 +1,1094 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+#ifndef LASTJSON_SAX_HPP__
+#define LASTJSON_SAX_HPP__
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "stringrep.hpp"
+#include "impl_helpers.hpp"
+#include "numparse.hpp"
+#include "structural_index.hpp"
+#include "utf8_validation.hpp"
+#include "parse_options.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Base class for SAX-style event handlers
+ *
+ * The SAX parser calls the following methods of its handler, which is a
+ * template parameter so the calls can be inlined:
+ *
+ *   on_null()
+ *   on_bool(bool)
+ *   on_int(int_type)
+ *   on_float(float_type)
+ *   on_string(char const * begin, char const * end)
+ *   on_key(char const * begin, char const * end)
+ *   on_start_array(), on_end_array()
+ *   on_start_object(), on_end_object()
+ *
+ * Strings and keys are passed unescaped and UTF-8 encoded. The range they
+ * are passed in is only valid during the call. Integers that do not fit
+ * int_type are reported via on_float.
+ *
+ * Deriving from this class is optional. It defines the number types and
+ * does nothing for every event, so a handler only needs to define the
+ * methods it is interested in.
+ */
+struct sax_handler
+{
+    typedef int64_t int_type;
+    typedef double float_type;
+
+    void on_null() {}
+    void on_bool(bool) {}
+    void on_int(int_type) {}
+    void on_float(float_type) {}
+    void on_string(char const *, char const *) {}
+    void on_key(char const *, char const *) {}
+    void on_start_array() {}
+    void on_end_array() {}
+    void on_start_object() {}
+    void on_end_object() {}
+};
+
+namespace impl {
+
+/**
+ * \brief Kind of an open container on the parser's stack
+ *
+ * Not a char type, so that writes to the stack do not alias the input.
+ */
+enum nesting
+{
+    IN_ARRAY,
+    IN_OBJECT
+};
+
+/**
+ * \brief Pass the text of a number to a handler after on_int or on_float
+ *
+ * This does nothing. It is overloaded for handlers that want the text,
+ * which event_parser finds by argument-dependent lookup.
+ */
+template<class Handler>
+inline void on_number_text(Handler &, char const *, char const *)
+{
+}
+
+/**
+ * \brief Tell a handler the number of elements of the array it was just told about
+ *
+ * This does nothing. Like on_number_text, it is overloaded for handlers
+ * that want to know, and only called where the number is known in advance.
+ */
+template<class Handler>
+inline void on_array_size(Handler &, std::size_t)
+{
+}
+
+/**
+ * \brief The JSON grammar, reporting what it finds to a handler
+ *
+ * Nested arrays and objects are kept on an explicit stack instead of the
+ * call stack, so the nesting depth is only limited by
+ * parse_options::max_depth. The stack is kept between calls.
+ */
+template<class Handler>
+class event_parser
+{
+public:
+    event_parser(Handler & handler, parse_options const & options = parse_options())
+        : m_handler(handler)
+        , m_max_depth(options.max_depth)
+        , m_error(PARSE_OK)
+        , m_error_position(0)
+    {
+    }
+
+    /**
+     * \brief Parse one JSON value and advance it past its end
+     *
+     * \return false if the data is invalid. error() and error_position()
+     * then tell why and where, and begin is left unchanged.
+     */
+    bool try_parse_value(char const * & begin, char const * end)
+    {
+        // work on a local copy that the compiler can keep in a register
+        char const * it = begin;
+        std::size_t depth = 0;
+        bool in_object = false;     // kind of the innermost open container
+
+        while (true)
+        {
+            if (in_object)
+            {
+                // at the start of an object member
+                it = parse_key(it, end);
+                if (!it)
+                {
+                    return false;
+                }
+            }
+
+            // it points to the start of a value
+            if (it == end)
+            {
+                return fail(PARSE_PREMATURE_END, it);
+            }
+
+            if (*it == '[')
+            {
+                if (depth >= m_max_depth)
+                {
+                    return fail(PARSE_NESTED_TOO_DEEPLY, it);
+                }
+
+                ++it;
+                skipws(it, end);
+                if (it == end)
+                {
+                    return fail(PARSE_PREMATURE_END_IN_ARRAY, it);
+                }
+
+                m_handler.on_start_array();
+                if (*it != ']')
+                {
+                    push(depth, IN_ARRAY);
+                    in_object = false;
+                    continue;
+                }
+
+                ++it;
+                m_handler.on_end_array();
+            }
+            else if (*it == '{')
+            {
+                if (depth >= m_max_depth)
+                {
+                    return fail(PARSE_NESTED_TOO_DEEPLY, it);
+                }
+
+                ++it;
+                skipws(it, end);
+                if (it == end)
+                {
+                    return fail(PARSE_PREMATURE_END_IN_OBJECT, it);
+                }
+
+                m_handler.on_start_object();
+                if (*it != '}')
+                {
+                    push(depth, IN_OBJECT);
+                    in_object = true;
+                    continue;
+                }
+
+                ++it;
+                m_handler.on_end_object();
+            }
+            else
+            {
+                it = parse_scalar(it, end);
+                if (!it)
+                {
+                    return false;
+                }
+            }
+
+            // a value is complete, close all containers that end here
+            while (true)
+            {
+                if (depth == 0)
+                {
+                    begin = it;
+                    return true;
+                }
+
+                skipws(it, end);
+                if (it == end)
+                {
+                    return fail(in_object ? PARSE_PREMATURE_END_IN_OBJECT : PARSE_PREMATURE_END_IN_ARRAY, it);
+                }
+
+                if (*it == ',')
+                {
+                    ++it;
+                    skipws(it, end);
+                    break;
+                }
+
+                if (!in_object && *it == ']')
+                {
+                    ++it;
+                    --depth;
+                    in_object = depth && m_stack[depth - 1] == IN_OBJECT;
+                    m_handler.on_end_array();
+                }
+                else if (in_object && *it == '}')
+                {
+                    ++it;
+                    --depth;
+                    in_object = depth && m_stack[depth - 1] == IN_OBJECT;
+                    m_handler.on_end_object();
+                }
+                else
+                {
+                    return fail(in_object ? PARSE_INVALID_OBJECT : PARSE_INVALID_ARRAY, it);
+                }
+            }
+        }
+    }
+
+    void parse_value(char const * & begin, char const * end)
+    {
+        if (!try_parse_value(begin, end))
+        {
+            throw_parser_error(m_error);
+        }
+    }
+
+    /**
+     * \brief Read a string whose opening quote has been consumed
+     *
+     * If the string contains no escape sequences, [a, b) is set to its
+     * contents within the input. Otherwise it is unescaped into an internal
+     * buffer, which [a, b) then refers to.
+     *
+     * \return false if the string is invalid, see error()
+     */
+    bool try_read_string(char const * & it, char const * end, char const * & a, char const * & b)
+    {
+        char const * const str_begin = it;
+
+        it = find_quote_or_backslash(it, end);
+        if (it == end)
+        {
+            return fail(PARSE_PREMATURE_END_IN_STRING, it);
+        }
+
+        if (*it == '"')
+        {
+            a = str_begin;
+            b = it;
+            ++it;
+            return true;
+        }
+
+        m_buffer.assign(str_begin, it);
+        parse_error_code const code = try_unescape_string(it, end, m_buffer);
+        if (code)
+        {
+            return fail(code, it);
+        }
+
+        a = m_buffer.data();
+        b = a + m_buffer.size();
+        return true;
+    }
+
+    void read_string(char const * & it, char const * end, char const * & a, char const * & b)
+    {
+        if (!try_read_string(it, end, a, b))
+        {
+            throw_parser_error(m_error);
+        }
+    }
+
+    Handler & handler()
+    {
+        return m_handler;
+    }
+
+    /**
+     * \brief Why the last failed call rejected the data
+     */
+    parse_error_code error() const
+    {
+        return m_error;
+    }
+
+    /**
+     * \brief Where in the input the last failed call detected the error
+     */
+    char const * error_position() const
+    {
+        return m_error_position;
+    }
+
+private:
+    Handler & m_handler;
+    std::size_t m_max_depth;
+    std::vector<nesting> m_stack;   // grows as needed, never shrinks
+    std::string m_buffer;
+    parse_error_code m_error;
+    char const * m_error_position;
+
+    bool fail(parse_error_code code, char const * where)
+    {
+        m_error = code;
+        m_error_position = where;
+        return false;
+    }
+
+    void push(std::size_t & depth, nesting container)
+    {
+        if (depth == m_stack.size())
+        {
+            m_stack.resize(depth ? 2 * depth : 32);
+        }
+
+        m_stack[depth++] = container;
+    }
+
+    /**
+     * \brief Parse a string, number or literal and return its end
+     *
+     * The iterator is passed by value so that the caller's copy need not
+     * live in memory. Returns 0 if the data is invalid.
+     */
+    char const * parse_scalar(char const * it, char const * end)
+    {
+        switch (*it)
+        {
+        case 'n':
+            if (end - it >= 4 && std::memcmp(it, "null", 4) == 0)
+            {
+                it += 4;
+                m_handler.on_null();
+                return it;
+            }
+
+            break;
+
+        case 'f':
+            if (end - it >= 5 && std::memcmp(it, "false", 5) == 0)
+            {
+                it += 5;
+                m_handler.on_bool(false);
+                return it;
+            }
+
+            break;
+
+        case 't':
+            if (end - it >= 4 && std::memcmp(it, "true", 4) == 0)
+            {
+                it += 4;
+                m_handler.on_bool(true);
+                return it;
+            }
+
+            break;
+
+        case '"':
+        {
+            ++it;
+            char const * a;
+            char const * b;
+            if (!try_read_string(it, end, a, b))
+            {
+                return 0;
+            }
+
+            m_handler.on_string(a, b);
+            return it;
+        }
+
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '+': case '-': case '.':
+        {
+            char const * const number_begin = it;
+            parse_error_code const code = try_parse_number(it, end, m_handler);
+            if (code)
+            {
+                fail(code, it);
+                return 0;
+            }
+
+            on_number_text(m_handler, number_begin, it);
+            return it;
+        }
+
+        default:
+            break;
+        }
+
+        fail(PARSE_INVALID_DATA, it);
+        return 0;
+    }
+
+    /**
+     * \brief Parse an object key and return the start of the member's value
+     *
+     * Returns 0 if the data is invalid.
+     */
+    char const * parse_key(char const * it, char const * end)
+    {
+        if (*it != '"')
+        {
+            fail(PARSE_INVALID_OBJECT, it);
+            return 0;
+        }
+
+        ++it;
+        char const * key_a;
+        char const * key_b;
+        if (!try_read_string(it, end, key_a, key_b))
+        {
+            return 0;
+        }
+
+        m_handler.on_key(key_a, key_b);
+        skipws(it, end);
+        if (it == end)
+        {
+            fail(PARSE_PREMATURE_END_IN_OBJECT, it);
+            return 0;
+        }
+
+        if (*it != ':')
+        {
+            fail(PARSE_INVALID_OBJECT, it);
+            return 0;
+        }
+
+        ++it;
+        skipws(it, end);
+        if (it == end)
+        {
+            fail(PARSE_PREMATURE_END_IN_OBJECT, it);
+            return 0;
+        }
+
+        return it;
+    }
+};
+
+/**
+ * \brief Skip a string whose opening quote has been consumed
+ */
+inline void skip_string(char const * & it, char const * end)
+{
+    while (true)
+    {
+        it = find_quote_or_backslash(it, end);
+        if (it == end)
+        {
+            break;
+        }
+
+        if (*(it++) == '"')
+        {
+            return;
+        }
+
+        // skip the escaped character
+        if (it == end)
+        {
+            break;
+        }
+
+        ++it;
+    }
+
+    throw parser_error("premature end of json data while parsing string");
+}
+
+/**
+ * \brief Skip the JSON value at it without building anything
+ *
+ * Arrays and objects are only scanned for their closing bracket, with
+ * strings skipped as a whole, so their contents are not validated. Scalars
+ * are parsed.
+ *
+ * \param max_depth Number of nested arrays and objects allowed
+ */
+inline void skip_value(char const * & it, char const * end, std::size_t max_depth)
+{
+    skipws(it, end);
+    if (it == end)
+    {
+        throw parser_error("premature end of json data");
+    }
+
+    switch (*it)
+    {
+    case '"':
+        ++it;
+        skip_string(it, end);
+        break;
+
+    case '[': case '{':
+    {
+        bool const array = *it == '[';
+        std::size_t nesting = 0;
+        while (it != end)
+        {
+            char const c = *(it++);
+            if (c == '"')
+            {
+                skip_string(it, end);
+            }
+            else if (c == '[' || c == '{')
+            {
+                if (++nesting > max_depth)
+                {
+                    throw parser_error("json data nested too deeply");
+                }
+            }
+            else if ((c == ']' || c == '}') && --nesting == 0)
+            {
+                return;
+            }
+        }
+
+        throw parser_error(array ? "premature end of json data while parsing array"
+                                 : "premature end of json data while parsing object");
+    }
+
+    default:
+    {
+        sax_handler ignore;
+        event_parser<sax_handler>(ignore).parse_value(it, end);
+    }
+    }
+}
+
+/**
+ * \brief Count the elements of every array in a structural index
+ *
+ * sizes receives one count per '[' in the index, in document order. The
+ * counts are only meaningful for valid JSON data.
+ */
+inline void count_array_elements(char const * begin, std::vector<uint32_t> const & index,
+                                 std::vector<uint32_t> & sizes)
+{
+    std::size_t const no_array = std::size_t(-1);
+    std::vector<std::size_t> open;  // offset in sizes of each open array, no_array for objects
+    sizes.clear();
+
+    std::size_t const n = index.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        switch (begin[index[i]])
+        {
+        case '"':
+            ++i;    // the closing quote
+            break;
+        case '[':
+            open.push_back(sizes.size());
+            sizes.push_back(i + 1 < n && begin[index[i + 1]] != ']');
+            break;
+        case '{':
+            open.push_back(no_array);
+            break;
+        case ']': case '}':
+            if (!open.empty())
+            {
+                open.pop_back();
+            }
+            break;
+        case ',':
+            if (!open.empty() && open.back() != no_array)
+            {
+                ++sizes[open.back()];
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Stage two of the indexed parser: walk a structural index
+ *
+ * Whitespace is never looked at, and the extent of every string is known
+ * from the index, so strings without escape sequences are passed on without
+ * scanning them byte by byte. Numbers and literals are handed over to the
+ * event_parser. Like event_parser, it does not recurse.
+ */
+template<class Handler>
+class indexed_event_parser
+{
+public:
+    indexed_event_parser(Handler & handler, char const * begin, char const * end,
+                         std::vector<uint32_t> const & index,
+                         parse_options const & options = parse_options())
+        : m_parser(handler)
+        , m_begin(begin)
+        , m_end(end)
+        , m_index(index)
+        , m_pos(0)
+        , m_max_depth(options.max_depth)
+        , m_presize(options.presize_arrays)
+        , m_arrays(0)
+        , m_error(PARSE_OK)
+        , m_error_position(0)
+    {
+        if (m_presize)
+        {
+            count_array_elements(begin, index, m_array_sizes);
+        }
+    }
+
+    /**
+     * \brief Parse the indexed document
+     *
+     * \return false if the data is invalid, see error() and error_position()
+     */
+    bool try_parse_document()
+    {
+        if (!parse_value())
+        {
+            return false;
+        }
+
+        if (m_pos != m_index.size())
+        {
+            return fail(PARSE_TRAILING_DATA, m_begin + m_index[m_pos]);
+        }
+
+        return true;
+    }
+
+    void parse_document()
+    {
+        if (!try_parse_document())
+        {
+            throw_parser_error(m_error);
+        }
+    }
+
+    parse_error_code error() const
+    {
+        return m_error;
+    }
+
+    char const * error_position() const
+    {
+        return m_error_position;
+    }
+
+private:
+    event_parser<Handler> m_parser;
+    char const * m_begin;
+    char const * m_end;
+    std::vector<uint32_t> const & m_index;
+    std::size_t m_pos;
+    std::size_t m_max_depth;
+    std::vector<nesting> m_stack;   // grows as needed, never shrinks
+    bool m_presize;
+    std::vector<uint32_t> m_array_sizes;
+    std::size_t m_arrays;           // arrays started so far
+    parse_error_code m_error;
+    char const * m_error_position;
+
+    bool fail(parse_error_code code, char const * where)
+    {
+        m_error = code;
+        m_error_position = where;
+        return false;
+    }
+
+    bool fail(parse_error_code code)
+    {
+        return fail(code, m_pos == m_index.size() ? m_end : m_begin + m_index[m_pos]);
+    }
+
+    /**
+     * \brief Whether the index is exhausted, which is reported as error
+     */
+    bool at_end(parse_error_code premature_end)
+    {
+        return m_pos == m_index.size() && !fail(premature_end);
+    }
+
+    char current() const
+    {
+        return m_begin[m_index[m_pos]];
+    }
+
+    void push(std::size_t & depth, nesting container)
+    {
+        if (depth == m_stack.size())
+        {
+            m_stack.resize(depth ? 2 * depth : 32);
+        }
+
+        m_stack[depth++] = container;
+    }
+
+    bool read_string(char const * & a, char const * & b)
+    {
+        if (m_pos + 1 == m_index.size())
+        {
+            return fail(PARSE_PREMATURE_END_IN_STRING, m_end);
+        }
+
+        a = m_begin + m_index[m_pos] + 1;
+        b = m_begin + m_index[m_pos + 1];
+        m_pos += 2;
+
+        if (std::memchr(a, '\\', b - a))
+        {
+            char const * it = a;
+            if (!m_parser.try_read_string(it, m_end, a, b))
+            {
+                return fail(m_parser.error(), m_parser.error_position());
+            }
+        }
+
+        return true;
+    }
+
+    bool parse_key()
+    {
+        if (at_end(PARSE_PREMATURE_END_IN_OBJECT))
+        {
+            return false;
+        }
+
+        if (current() != '"')
+        {
+            return fail(PARSE_INVALID_OBJECT);
+        }
+
+        char const * key_a;
+        char const * key_b;
+        if (!read_string(key_a, key_b))
+        {
+            return false;
+        }
+
+        m_parser.handler().on_key(key_a, key_b);
+        if (at_end(PARSE_PREMATURE_END_IN_OBJECT))
+        {
+            return false;
+        }
+
+        if (current() != ':')
+        {
+            return fail(PARSE_INVALID_OBJECT);
+        }
+
+        ++m_pos;
+        return true;
+    }
+
+    bool parse_value()
+    {
+        Handler & handler = m_parser.handler();
+        std::size_t depth = 0;
+        bool in_object = false;     // kind of the innermost open container
+
+        while (true)
+        {
+            // at the start of an object member, if in an object
+            if (in_object && !parse_key())
+            {
+                return false;
+            }
+
+            if (at_end(PARSE_PREMATURE_END))
+            {
+                return false;
+            }
+
+            switch (current())
+            {
+            case '"':
+            {
+                char const * a;
+                char const * b;
+                if (!read_string(a, b))
+                {
+                    return false;
+                }
+
+                handler.on_string(a, b);
+                break;
+            }
+
+            case '[':
+                if (depth >= m_max_depth)
+                {
+                    return fail(PARSE_NESTED_TOO_DEEPLY);
+                }
+
+                ++m_pos;
+                handler.on_start_array();
+                if (m_presize)
+                {
+                    on_array_size(handler, m_array_sizes[m_arrays++]);
+                }
+
+                if (at_end(PARSE_PREMATURE_END_IN_ARRAY))
+                {
+                    return false;
+                }
+
+                if (current() != ']')
+                {
+                    push(depth, IN_ARRAY);
+                    in_object = false;
+                    continue;
+                }
+
+                ++m_pos;
+                handler.on_end_array();
+                break;
+
+            case '{':
+                if (depth >= m_max_depth)
+                {
+                    return fail(PARSE_NESTED_TOO_DEEPLY);
+                }
+
+                ++m_pos;
+                handler.on_start_object();
+                if (at_end(PARSE_PREMATURE_END_IN_OBJECT))
+                {
+                    return false;
+                }
+
+                if (current() != '}')
+                {
+                    push(depth, IN_OBJECT);
+                    in_object = true;
+                    continue;
+                }
+
+                ++m_pos;
+                handler.on_end_object();
+                break;
+
+            case ']': case '}': case ',': case ':':
+                return fail(PARSE_INVALID_DATA);
+
+            default:
+            {
+                // a number or literal, which ends before the next index entry
+                char const * it = m_begin + m_index[m_pos];
+                ++m_pos;
+                char const * const token_end =
+                    m_pos == m_index.size() ? m_end : m_begin + m_index[m_pos];
+                if (!m_parser.try_parse_value(it, token_end))
+                {
+                    return fail(m_parser.error(), m_parser.error_position());
+                }
+
+                skipws(it, token_end);
+                if (it != token_end)
+                {
+                    return fail(PARSE_INVALID_DATA, it);
+                }
+            }
+            }
+
+            // a value is complete, close all containers that end here
+            while (true)
+            {
+                if (depth == 0)
+                {
+                    return true;
+                }
+
+                if (at_end(in_object ? PARSE_PREMATURE_END_IN_OBJECT : PARSE_PREMATURE_END_IN_ARRAY))
+                {
+                    return false;
+                }
+
+                char const c = current();
+                if (c == ',')
+                {
+                    ++m_pos;
+                    break;
+                }
+
+                if (!in_object && c == ']')
+                {
+                    handler.on_end_array();
+                }
+                else if (in_object && c == '}')
+                {
+                    handler.on_end_object();
+                }
+                else
+                {
+                    return fail(in_object ? PARSE_INVALID_OBJECT : PARSE_INVALID_ARRAY);
+                }
+
+                ++m_pos;
+                --depth;
+                in_object = depth && m_stack[depth - 1] == IN_OBJECT;
+            }
+        }
+    }
+};
+
+/**
+ * \brief Parse using the structural index engine
+ *
+ * Reports the same events as event_parser followed by a check for trailing
+ * data.
+ */
+template<class Handler>
+inline void parse_indexed(char const * begin, char const * end, Handler & handler,
+                          simd_level level = available_simd_level(),
+                          parse_options const & options = parse_options())
+{
+    std::vector<uint32_t> index;
+    build_structural_index(begin, end - begin, index, level);
+    indexed_event_parser<Handler>(handler, begin, end, index, options).parse_document();
+}
+
+/**
+ * \brief Whether the structural index engine should be used
+ *
+ * The index pays off once the input spans a few blocks and a vector unit is
+ * available to build it. Otherwise event_parser is used.
+ */
+inline bool use_indexed_parser(std::size_t size)
+{
+    return size >= 256 && size <= std::numeric_limits<uint32_t>::max()
+        && available_simd_level() != SIMD_NONE;
+}
+
+/**
+ * \brief Throw a parser_error if the options ask for valid UTF-8 and it is not
+ */
+inline void check_utf8(char const * begin, char const * end, parse_options const & options)
+{
+    if (options.validate_utf8 && validate_utf8(begin, end) != end)
+    {
+        throw_parser_error(PARSE_INVALID_UTF8);
+    }
+}
+
+/**
+ * \brief Parse a complete JSON document, reporting events to a handler
+ *
+ * Invalid data is reported by the result rather than by an exception. The
+ * handler may have received events for the part before the error.
+ */
+template<class Handler>
+inline parse_result try_parse_events(char const * begin, char const * end, Handler & handler,
+                                     parse_options const & options = parse_options())
+{
+    if (options.validate_utf8)
+    {
+        char const * const invalid = validate_utf8(begin, end);
+        if (invalid != end)
+        {
+            return parse_result(PARSE_INVALID_UTF8, invalid - begin);
+        }
+    }
+
+    char const * it = begin;
+    skipws(it, end);
+    if (use_indexed_parser(end - it))
+    {
+        std::vector<uint32_t> index;
+        build_structural_index(it, end - it, index, available_simd_level());
+        indexed_event_parser<Handler> parser(handler, it, end, index, options);
+        if (!parser.try_parse_document())
+        {
+            return parse_result(parser.error(), parser.error_position() - begin);
+        }
+
+        return parse_result();
+    }
+
+    event_parser<Handler> parser(handler, options);
+    if (!parser.try_parse_value(it, end))
+    {
+        return parse_result(parser.error(), parser.error_position() - begin);
+    }
+
+    skipws(it, end);
+    if (it != end)
+    {
+        return parse_result(PARSE_TRAILING_DATA, it - begin);
+    }
+
+    return parse_result();
+}
+
+template<class Handler>
+inline void parse_events(char const * begin, char const * end, Handler & handler,
+                         parse_options const & options = parse_options())
+{
+    parse_result const result = try_parse_events(begin, end, handler, options);
+    if (!result.ok())
+    {
+        throw_parser_error(result.code);
+    }
+}
+
+} // namespace impl
+
+/**
+ * \brief Parse JSON data without building a value, reporting to a handler
+ *
+ * See sax_handler for the events the handler receives.
+ */
+template<class Handler>
+inline void sax_parse(char const * begin, char const * end, Handler & handler)
+{
+    impl::parse_events(begin, end, handler);
+}
+
+template<class Handler>
+inline void sax_parse(char const * data, std::size_t size, Handler & handler)
+{
+    impl::parse_events(data, data + size, handler);
+}
+
+template<class Handler>
+inline void sax_parse(std::string const & str, Handler & handler)
+{
+    impl::parse_events(str.data(), str.data() + str.size(), handler);
+}
+
+template<class Handler>
+inline void sax_parse(char const * begin, char const * end, Handler & handler,
+                      parse_options const & options)
+{
+    impl::parse_events(begin, end, handler, options);
+}
+
+template<class Handler>
+inline void sax_parse(std::string const & str, Handler & handler, parse_options const & options)
+{
+    impl::parse_events(str.data(), str.data() + str.size(), handler, options);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_SAX_HPP__
@@ -0,0 +1,104 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+
+#ifndef LASTJSON_STREAM_PARSE_HPP__
+#define LASTJSON_STREAM_PARSE_HPP__
+
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+#include "value.hpp"
+#include "parse_options.hpp"
+#include "push_parser.hpp"
+
+namespace lastjson {
+
+/**
+ * \brief Parse a JSON document read from a stream buffer
+ *
+ * The input is read in blocks of block_size bytes, which are handed to a
+ * push parser, so apart from the parsed value only one block and a token cut
+ * by its end are held in memory. All of the input up to the end of the
+ * stream must be a single JSON document, optionally surrounded by
+ * whitespace.
+ */
+template<class Value>
+inline Value parse_stream(std::streambuf & in, parse_options const & options = parse_options(),
+                          std::size_t block_size = 64 * 1024)
+{
+    basic_push_parser<Value> parser(options);
+    std::vector<char> block(block_size ? block_size : 1);
+    while (true)
+    {
+        std::streamsize const n = in.sgetn(&block[0], block.size());
+        if (n <= 0)
+        {
+            break;
+        }
+
+        parser.feed(&block[0], n);
+    }
+
+    return parser.finish();
+}
+
+/**
+ * \brief Parse a JSON document read from an input stream
+ *
+ * This reads from the stream's buffer until its end, see
+ * parse_stream(std::streambuf &), and sets eofbit on the stream. failbit is
+ * set instead if the stream is not good to begin with.
+ */
+template<class Value>
+inline Value parse_stream(std::istream & in, parse_options const & options = parse_options(),
+                          std::size_t block_size = 64 * 1024)
+{
+    if (!in.good() || !in.rdbuf())
+    {
+        in.setstate(std::ios_base::failbit);
+        throw parser_error("premature end of json data");
+    }
+
+    Value result = parse_stream<Value>(*in.rdbuf(), options, block_size);
+    in.setstate(std::ios_base::eofbit);
+    return result;
+}
+
+inline value parse_stream(std::streambuf & in, parse_options const & options = parse_options(),
+                          std::size_t block_size = 64 * 1024)
+{
+    return parse_stream<value>(in, options, block_size);
+}
+
+inline value parse_stream(std::istream & in, parse_options const & options = parse_options(),
+                          std::size_t block_size = 64 * 1024)
+{
+    return parse_stream<value>(in, options, block_size);
+}
+
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_STREAM_PARSE_HPP__
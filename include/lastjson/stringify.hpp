@@ -34,8 +34,25 @@ THE SOFTWARE.
 
 namespace lastjson {
 
+/**
+ * \brief Binding of a struct's members to the keys of a JSON object
+ *
+ * This is specialised with the macros of binding.hpp, see there.
+ */
+template<class T>
+struct binding
+{
+};
+
 namespace impl {
 
+/// void if T has a binding, otherwise no type
+template<class T>
+struct if_bound
+{
+    typedef void type;
+};
+
 template<typename Iterator>
 inline void write_json_object(std::ostream & stream, Iterator begin, Iterator end);
 
@@ -119,20 +136,26 @@ inline void write_json(std::ostream & stream, char const * data)
     escape_string(stream, data);
 }
 
-template<typename T>
-inline void write_json(std::ostream & stream, std::map<std::string, T> const & data)
+template<typename Traits, typename Alloc>
+inline void write_json(std::ostream & stream, std::basic_string<char, Traits, Alloc> const & data)
+{
+    escape_string(stream, data);
+}
+
+template<typename Key, typename T, typename Compare, typename Alloc>
+inline void write_json(std::ostream & stream, std::map<Key, T, Compare, Alloc> const & data)
 {
     impl::write_json_object(stream, data.begin(), data.end());
 }
 
-template<typename T>
-inline void write_json(std::ostream & stream, std::vector< std::pair<std::string, T> > const & data)
+template<typename T, typename Alloc>
+inline void write_json(std::ostream & stream, std::vector< std::pair<std::string, T>, Alloc > const & data)
 {
     impl::write_json_object(stream, data.begin(), data.end());
 }
 
-template<typename T>
-inline void write_json(std::ostream & stream, std::vector<T> const & data)
+template<typename T, typename Alloc>
+inline void write_json(std::ostream & stream, std::vector<T, Alloc> const & data)
 {
     impl::write_json_array(stream, data.begin(), data.end());
 }
@@ -143,6 +166,11 @@ inline void write_json(std::ostream & stream, basic_value<V> const & data)
     data.write_json(stream);
 }
 
+/// For structs with a binding, defined in binding.hpp
+template<typename T>
+inline typename impl::if_bound<typename binding<T>::bound_type>::type
+write_json(std::ostream & stream, T const & object);
+
 template<typename T>
 inline std::string stringify(T const & t)
 {
@@ -163,19 +191,52 @@ inline void basic_value<V>::write_json(std::ostream & stream) const
         ::lastjson::write_json(stream, m_data.boolean);
         break;
     case INT:
-        ::lastjson::write_json(stream, m_data.integer);
-        break;
     case FLOAT:
-        ::lastjson::write_json(stream, m_data.floatingpoint);
+        if (m_storage == LEXEME)
+        {
+            char const * begin;
+            char const * end;
+            get_number_text(begin, end);
+            stream.write(begin, end - begin);
+        }
+        else if (m_type == INT)
+        {
+            ::lastjson::write_json(stream, m_data.integer);
+        }
+        else
+        {
+            ::lastjson::write_json(stream, m_data.floatingpoint);
+        }
         break;
     case STRING:
-        ::lastjson::write_json(stream, string_ref_dangerous());
+        if (m_storage == SLICE)
+        {
+            char const * begin;
+            char const * end;
+            get_string_range(begin, end);
+            impl::escape_string_range(stream, begin, end, true, false);
+        }
+        else
+        {
+            ::lastjson::write_json(stream, string_ref_dangerous());
+        }
         break;
     case ARRAY:
-        ::lastjson::write_json(stream, array_ref_dangerous());
-        break;
     case OBJECT:
-        ::lastjson::write_json(stream, object_ref_dangerous());
+        if (is_lazy())
+        {
+            // an untouched subtree is written out exactly as it was parsed
+            impl::lazy_subtree const & subtree = lazy_ref();
+            stream.write(subtree.begin, subtree.end - subtree.begin);
+        }
+        else if (m_type == ARRAY)
+        {
+            ::lastjson::write_json(stream, array_ref_dangerous());
+        }
+        else
+        {
+            ::lastjson::write_json(stream, object_ref_dangerous());
+        }
         break;
     default:
         throw std::logic_error("basic_value::write_json encountered invalid type");
@@ -23,10 +23,20 @@ THE SOFTWARE.
 #ifndef LASTJSON_STRINGREP_HPP__
 #define LASTJSON_STRINGREP_HPP__
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <iterator>
+
+// Strings are scanned with SSE2 or AVX2 if the compiler targets them, so
+// the scan can be inlined into the parser. Define LASTJSON_NO_SIMD to
+// compile this out.
+#if !defined(LASTJSON_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__)
+# define LASTJSON_SIMD_STRINGS 1
+# include <immintrin.h>
+#endif
 
 #include "impl_helpers.hpp"
 
@@ -34,6 +44,190 @@ namespace lastjson {
 
 namespace impl {
 
+/**
+ * \brief Find the first quote or backslash in [it, end), or end
+ */
+template<class Iterator>
+inline Iterator find_quote_or_backslash(Iterator it, Iterator end)
+{
+    while (it != end && *it != '"' && *it != '\\')
+    {
+        ++it;
+    }
+
+    return it;
+}
+
+/**
+ * \brief Find the first quote or backslash in [it, end), or end
+ *
+ * Long runs of text without either are skipped a vector at a time.
+ */
+inline char const * find_quote_or_backslash(char const * it, char const * end)
+{
+#ifdef LASTJSON_SIMD_STRINGS
+# ifdef __AVX2__
+    __m256i const quote32 = _mm256_set1_epi8('"');
+    __m256i const backslash32 = _mm256_set1_epi8('\\');
+    while (end - it >= 32)
+    {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(it));
+        uint32_t const mask = uint32_t(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, backslash32))));
+        if (mask)
+        {
+            return it + __builtin_ctz(mask);
+        }
+
+        it += 32;
+    }
+# endif
+
+    __m128i const quote = _mm_set1_epi8('"');
+    __m128i const backslash = _mm_set1_epi8('\\');
+    while (end - it >= 16)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(it));
+        int const mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        if (mask)
+        {
+            return it + __builtin_ctz(mask);
+        }
+
+        it += 16;
+    }
+#endif
+
+    while (it != end && *it != '"' && *it != '\\')
+    {
+        ++it;
+    }
+
+    return it;
+}
+
+inline char * find_quote_or_backslash(char * it, char * end)
+{
+    return const_cast<char *>(find_quote_or_backslash(static_cast<char const *>(it), end));
+}
+
+/**
+ * \brief Decodes the escape sequence following a backslash
+ *
+ * \param it Iterator pointing to the character following the backslash. It
+ * is advanced past the escape sequence.
+ * \param end End of the input
+ * \param outit Output iterator the decoded UTF-8 bytes are written to
+ * \return PARSE_OK, or the reason the sequence is invalid
+ */
+template<class Iterator, class OutputIterator>
+inline parse_error_code try_unescape_sequence(Iterator & it, Iterator end, OutputIterator & outit)
+{
+    char const esc = *(it++);
+    switch (esc)
+    {
+    case 'b':
+        *(outit++) = '\b';
+        break;
+    case 'f':
+        *(outit++) = '\f';
+        break;
+    case 'n':
+        *(outit++) = '\n';
+        break;
+    case 'r':
+        *(outit++) = '\r';
+        break;
+    case 't':
+        *(outit++) = '\t';
+        break;
+    case '/': case '\\': case '"':
+        *(outit++) = esc;
+        break;
+    case 'u':
+    {
+        uint16_t codepoint;
+        parse_error_code code = try_read4hex(it, end, codepoint);
+        if (code)
+        {
+            return code;
+        }
+
+        if (codepoint < 0x80)
+        {
+            *(outit++) = codepoint;
+        }
+        else if (codepoint < 0x800)
+        {
+            *(outit++) = 0xc0 | ((codepoint >> 6) & 0x1f);
+            *(outit++) = 0x80 | (codepoint & 0x3f);
+        }
+        else if (codepoint < 0xd800 || codepoint >= 0xe000)
+        {
+            *(outit++) = 0xe0 | ((codepoint >> 12) & 0x0f);
+            *(outit++) = 0x80 | ((codepoint >> 6) & 0x3f);
+            *(outit++) = 0x80 | (codepoint & 0x3f);
+        }
+        else if (codepoint < 0xdc00)
+        {
+            if (it == end || *it != '\\' || ++it == end || *it != 'u')
+            {
+                return PARSE_INVALID_SURROGATE;
+            }
+
+            ++it;
+            uint16_t codepoint2;
+            code = try_read4hex(it, end, codepoint2);
+            if (code)
+            {
+                return code;
+            }
+
+            if (codepoint2 < 0xdc00 || codepoint2 >= 0xe000)
+            {
+                return PARSE_INVALID_SURROGATE;
+            }
+
+            uint32_t cp = (((codepoint & 0x3ff) << 10) | (codepoint2 & 0x3ff)) + 0x10000;
+            *(outit++) = 0xf0 | ((cp >> 18) & 0x07);
+            *(outit++) = 0x80 | ((cp >> 12) & 0x3f);
+            *(outit++) = 0x80 | ((cp >> 6) & 0x3f);
+            *(outit++) = 0x80 | (cp & 0x3f);
+        }
+        else
+        {
+            return PARSE_INVALID_SURROGATE;
+        }
+    }
+    break;
+    default:
+        return PARSE_INVALID_ESCAPE;
+    }
+
+    return PARSE_OK;
+}
+
+template<class Iterator, class OutputIterator>
+inline void unescape_sequence(Iterator & it, Iterator end, OutputIterator & outit)
+{
+    parse_error_code const code = try_unescape_sequence(it, end, outit);
+    if (code)
+    {
+        throw_parser_error(code);
+    }
+}
+
+/**
+ * \brief Unescapes a JSON string within the input
+ *
+ * Runs of characters between escape sequences are moved down in one go,
+ * and not at all before the first escape sequence.
+ *
+ * \param it Iterator pointing to the character following the opening quote.
+ * It is advanced past the closing quote.
+ * \param end End of the input
+ * \param a, b Set to the unescaped string
+ */
 template<class Iterator>
 inline void unescape_string_inplace(Iterator & it, Iterator end, Iterator & a, Iterator & b)
 {
@@ -42,6 +236,22 @@ inline void unescape_string_inplace(Iterator & it, Iterator end, Iterator & a, I
 
     while (it != end)
     {
+        Iterator const run_end = find_quote_or_backslash(it, end);
+        if (outit != it)
+        {
+            outit = std::copy(it, run_end, outit);
+        }
+        else
+        {
+            outit = run_end;
+        }
+
+        it = run_end;
+        if (it == end)
+        {
+            break;
+        }
+
         if (*it == '"')
         {
             ++it;
@@ -49,90 +259,76 @@ inline void unescape_string_inplace(Iterator & it, Iterator end, Iterator & a, I
             b = outit;
             return;
         }
-        else if (*it == '\\')
+
+        ++it;
+        if (it == end)
         {
-            ++it;
-            if (it == end)
-            {
-                break;
-            }
+            break;
+        }
 
-            char const esc = *(it++);
-            switch (esc)
-            {
-            case 'b':
-                *(outit++) = '\b';
-                break;
-            case 'f':
-                *(outit++) = '\f';
-                break;
-            case 'n':
-                *(outit++) = '\n';
-                break;
-            case 'r':
-                *(outit++) = '\r';
-                break;
-            case 't':
-                *(outit++) = '\t';
-                break;
-            case '/': case '\\': case '"':
-                *(outit++) = esc;
-                break;
-            case 'u':
-            {
-                uint16_t codepoint = read4hex(it, end);
-                if (codepoint < 0x80)
-                {
-                    *(outit++) = codepoint;
-                }
-                else if (codepoint < 0x800)
-                {
-                    *(outit++) = 0xc0 | ((codepoint >> 6) & 0x1f);
-                    *(outit++) = 0x80 | (codepoint & 0x3f);
-                }
-                else if (codepoint < 0xd800 || codepoint >= 0xe000)
-                {
-                    *(outit++) = 0xe0 | ((codepoint >> 12) & 0x0f);
-                    *(outit++) = 0x80 | ((codepoint >> 6) & 0x3f);
-                    *(outit++) = 0x80 | (codepoint & 0x3f);
-                }
-                else if (codepoint < 0xdc00)
-                {
-                    if (it == end || *it != '\\' || ++it == end || *it != 'u')
-                    {
-                        throw parser_error("error decoding surrogate unicode escape sequence");
-                    }
+        unescape_sequence(it, end, outit);
+    }
 
-                    ++it;
-                    uint16_t codepoint2 = read4hex(it, end);
-                    if (codepoint2 < 0xdc00 || codepoint2 >= 0xe000)
-                    {
-                        throw parser_error("error decoding surrogate unicode escape sequence");
-                    }
+    throw parser_error("premature end of json data while parsing string");
+}
 
-                    uint32_t cp = (((codepoint & 0x3ff) << 10) | (codepoint2 & 0x3ff)) + 0x10000;
-                    *(outit++) = 0xf0 | ((cp >> 18) & 0x07);
-                    *(outit++) = 0x80 | ((cp >> 12) & 0x3f);
-                    *(outit++) = 0x80 | ((cp >> 6) & 0x3f);
-                    *(outit++) = 0x80 | (cp & 0x3f);
-                }
-                else
-                {
-                    throw parser_error("error decoding surrogate unicode escape sequence");
-                }
-            }
+/**
+ * \brief Unescapes a JSON string without modifying the input
+ *
+ * Runs of characters that need no unescaping are appended to the output
+ * string in one go, so a string without escape sequences costs a single
+ * copy.
+ *
+ * \param it Iterator pointing to the character following the opening quote.
+ * It is advanced past the closing quote.
+ * \param end End of the input
+ * \param out The string the unescaped data is appended to
+ * \return PARSE_OK, or the reason the string is invalid
+ */
+template<class Iterator, class String>
+inline parse_error_code try_unescape_string(Iterator & it, Iterator end, String & out)
+{
+    while (it != end)
+    {
+        Iterator const run_end = find_quote_or_backslash(it, end);
+        out.append(it, run_end);
+        it = run_end;
+        if (it == end)
+        {
             break;
-            default:
-                throw parser_error("error while parsing backslash escape sequence");
-            }
         }
-        else
+
+        if (*it == '"')
         {
-            *(outit++) = *(it++);
+            ++it;
+            return PARSE_OK;
+        }
+
+        ++it;
+        if (it == end)
+        {
+            break;
+        }
+
+        std::back_insert_iterator<String> outit(out);
+        parse_error_code const code = try_unescape_sequence(it, end, outit);
+        if (code)
+        {
+            return code;
         }
     }
 
-    throw parser_error("premature end of json data while parsing string");
+    return PARSE_PREMATURE_END_IN_STRING;
+}
+
+template<class Iterator, class String>
+inline void unescape_string(Iterator & it, Iterator end, String & out)
+{
+    parse_error_code const code = try_unescape_string(it, end, out);
+    if (code)
+    {
+        throw_parser_error(code);
+    }
 }
 
 template<class IntType>
@@ -145,14 +341,13 @@ inline void output_hex(std::ostream & out, IntType value, unsigned int digits)
     }
 }
 
-} // namespace impl
-
-inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
-                                    bool const escape_utf8 = true, bool const escape_slash = false)
+template<class Iterator>
+inline std::ostream & escape_string_range(std::ostream & out, Iterator begin, Iterator end,
+                                    bool const escape_utf8, bool const escape_slash)
 {
     out << '"';
 
-    for (std::string::const_iterator it = txt.begin(); it != txt.end(); ++it)
+    for (Iterator it = begin; it != end; ++it)
     {
         unsigned char const c = *it;
 
@@ -188,7 +383,7 @@ inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
                 {
                     uint16_t codepoint = (c &  0x1f) << 6;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
@@ -202,14 +397,14 @@ inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
                 {
                     uint16_t codepoint = (c &  0x0f) << 12;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
 
                     codepoint |= (*it & 0x3f) << 6;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
@@ -223,21 +418,21 @@ inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
                 {
                     uint32_t codepoint = (c &  0x07) << 18;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
 
                     codepoint |= (*it & 0x3f) << 12;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
 
                     codepoint |= (*it & 0x3f) << 6;
                     ++it;
-                    if (it == txt.end() || (*it & 0xc0) != 0x80)
+                    if (it == end || (*it & 0xc0) != 0x80)
                     {
                         throw utf8_sequence_error();
                     }
@@ -308,6 +503,22 @@ inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
     return out;
 }
 
+} // namespace impl
+
+inline std::ostream & escape_string(std::ostream & out, std::string const & txt,
+                                    bool const escape_utf8 = true, bool const escape_slash = false)
+{
+    return impl::escape_string_range(out, txt.begin(), txt.end(), escape_utf8, escape_slash);
+}
+
+/// Overload for strings with another allocator, e.g. arena_string
+template<class Traits, class Alloc>
+inline std::ostream & escape_string(std::ostream & out, std::basic_string<char, Traits, Alloc> const & txt,
+                                    bool const escape_utf8 = true, bool const escape_slash = false)
+{
+    return impl::escape_string_range(out, txt.begin(), txt.end(), escape_utf8, escape_slash);
+}
+
 inline std::string escape_string(std::string const & txt,
                                  bool const escape_utf8 = true, bool const escape_slash = false)
 {
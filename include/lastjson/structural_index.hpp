@@ -0,0 +1,362 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+#ifndef LASTJSON_STRUCTURAL_INDEX_HPP__
+#define LASTJSON_STRUCTURAL_INDEX_HPP__
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "impl_helpers.hpp"
+
+// The vectorised classifiers need GCC-style function target attributes and
+// runtime CPU detection. Define LASTJSON_NO_SIMD to compile them out.
+#if !defined(LASTJSON_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define LASTJSON_SIMD 1
+# include <immintrin.h>
+#endif
+
+namespace lastjson {
+
+namespace impl {
+
+/**
+ * \brief Instruction set extensions usable for building a structural index
+ */
+enum simd_level
+{
+    SIMD_NONE = 0,
+    SIMD_SSE2 = 1,
+    SIMD_AVX2 = 2
+};
+
+/**
+ * \brief Determine the best instruction set extension of the running CPU
+ */
+inline simd_level detect_simd_level()
+{
+#ifdef LASTJSON_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SIMD_AVX2;
+    }
+
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return SIMD_SSE2;
+    }
+#endif
+
+    return SIMD_NONE;
+}
+
+/**
+ * \brief The detected instruction set extension, cached after the first call
+ */
+inline simd_level available_simd_level()
+{
+    static simd_level const level = detect_simd_level();
+    return level;
+}
+
+/**
+ * \brief Character classes of one 64 byte block, one bit per byte
+ */
+struct block_masks
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;            // one of {}[]:,
+    uint64_t whitespace;
+};
+
+inline void classify_block_scalar(char const * p, block_masks & m)
+{
+    m.quote = m.backslash = m.op = m.whitespace = 0;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        uint64_t const bit = uint64_t(1) << i;
+
+        switch (p[i])
+        {
+        case '"':
+            m.quote |= bit;
+            break;
+        case '\\':
+            m.backslash |= bit;
+            break;
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            m.op |= bit;
+            break;
+        case 0x20: case 0x09: case 0x0a: case 0x0d:
+            m.whitespace |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#ifdef LASTJSON_SIMD
+
+__attribute__((target("sse2")))
+inline void classify_block_sse2(char const * p, block_masks & m)
+{
+    m.quote = m.backslash = m.op = m.whitespace = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + 16 * i));
+        // '[' ']' '{' '}' only differ from each other in bits 0x20 and 0x02
+        __m128i const v20 = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        int const shift = 16 * i;
+
+        m.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << shift;
+        m.backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << shift;
+
+        __m128i op = _mm_or_si128(_mm_cmpeq_epi8(v20, _mm_set1_epi8('{')),
+                                  _mm_cmpeq_epi8(v20, _mm_set1_epi8('}')));
+        op = _mm_or_si128(op, _mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+        op = _mm_or_si128(op, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+        m.op |= uint64_t(uint16_t(_mm_movemask_epi8(op))) << shift;
+
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x20)),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8(0x09)));
+        ws = _mm_or_si128(ws, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x0a)));
+        ws = _mm_or_si128(ws, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x0d)));
+        m.whitespace |= uint64_t(uint16_t(_mm_movemask_epi8(ws))) << shift;
+    }
+}
+
+__attribute__((target("avx2")))
+inline void classify_block_avx2(char const * p, block_masks & m)
+{
+    m.quote = m.backslash = m.op = m.whitespace = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + 32 * i));
+        __m256i const v20 = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        int const shift = 32 * i;
+
+        m.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << shift;
+        m.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << shift;
+
+        __m256i op = _mm256_or_si256(_mm256_cmpeq_epi8(v20, _mm256_set1_epi8('{')),
+                                     _mm256_cmpeq_epi8(v20, _mm256_set1_epi8('}')));
+        op = _mm256_or_si256(op, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')));
+        op = _mm256_or_si256(op, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+        m.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << shift;
+
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x20)),
+                                     _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x09)));
+        ws = _mm256_or_si256(ws, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x0a)));
+        ws = _mm256_or_si256(ws, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x0d)));
+        m.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(ws))) << shift;
+    }
+}
+
+#endif // ifdef LASTJSON_SIMD
+
+inline int count_trailing_zeros(uint64_t x)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1))
+    {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/**
+ * \brief Follows escape sequences and strings across consecutive blocks
+ */
+class string_tracker
+{
+public:
+    string_tracker()
+        : m_escape_carry(false)
+        , m_in_string_carry(0)
+    {
+    }
+
+    /**
+     * \brief Process the next block
+     *
+     * \param m Character classes of the block
+     * \param quote Set to the quotes that open or close a string
+     * \return The bits of all characters inside of strings, quotes excluded
+     */
+    uint64_t next(block_masks const & m, uint64_t & quote)
+    {
+        // Backslashes are rare, so walk them one by one: an unescaped
+        // backslash escapes the character following it.
+        uint64_t escaped = m_escape_carry ? 1 : 0;
+        m_escape_carry = false;
+
+        for (uint64_t bs = m.backslash & ~escaped; bs; bs &= bs - 1)
+        {
+            uint64_t const bit = bs & (~bs + 1);
+            if (escaped & bit)
+            {
+                continue;
+            }
+
+            if (bit == (uint64_t(1) << 63))
+            {
+                m_escape_carry = true;
+            }
+            else
+            {
+                escaped |= bit << 1;
+            }
+        }
+
+        quote = m.quote & ~escaped;
+
+        // prefix xor: every bit from an opening quote up to, but excluding,
+        // the matching closing quote is set
+        uint64_t in_string = quote;
+        in_string ^= in_string << 1;
+        in_string ^= in_string << 2;
+        in_string ^= in_string << 4;
+        in_string ^= in_string << 8;
+        in_string ^= in_string << 16;
+        in_string ^= in_string << 32;
+        in_string ^= m_in_string_carry;
+        m_in_string_carry = uint64_t(0) - (in_string >> 63);
+
+        return in_string & ~quote;
+    }
+
+private:
+    bool m_escape_carry;
+    uint64_t m_in_string_carry;
+};
+
+/**
+ * \brief Turns the character classes of consecutive blocks into an index
+ *
+ * The index lists the offsets of all structural characters outside strings,
+ * of the opening and closing quote of every string, and of the first
+ * character of every other token (numbers and literals). Whitespace and the
+ * contents of strings never appear in the index.
+ */
+class structural_indexer
+{
+public:
+    structural_indexer(std::vector<uint32_t> & index)
+        : m_index(index)
+        , m_scalar_carry(0)
+    {
+    }
+
+    void add_block(block_masks const & m, uint32_t base)
+    {
+        uint64_t quote;
+        uint64_t const inside = m_strings.next(m, quote);
+        uint64_t const scalar = ~(m.op | m.whitespace | quote | inside);
+        uint64_t const scalar_start = scalar & ~((scalar << 1) | m_scalar_carry);
+        m_scalar_carry = scalar >> 63;
+
+        for (uint64_t bits = ((m.op & ~inside) | quote | scalar_start); bits; bits &= bits - 1)
+        {
+            m_index.push_back(base + count_trailing_zeros(bits));
+        }
+    }
+
+private:
+    std::vector<uint32_t> & m_index;
+    string_tracker m_strings;
+    uint64_t m_scalar_carry;
+};
+
+typedef void (*block_classifier_function)(char const *, block_masks &);
+
+/**
+ * \brief The block classifier for the given instruction set
+ */
+inline block_classifier_function block_classifier(simd_level level)
+{
+#ifdef LASTJSON_SIMD
+    if (level >= SIMD_AVX2)
+    {
+        return classify_block_avx2;
+    }
+    else if (level >= SIMD_SSE2)
+    {
+        return classify_block_sse2;
+    }
+#else
+    (void) level;
+#endif
+
+    return classify_block_scalar;
+}
+
+/**
+ * \brief Stage one of the indexed parser: find all structural positions
+ *
+ * \param begin Pointer to the JSON data
+ * \param size Number of bytes of JSON data (must be less than 4 GiB)
+ * \param index Vector the offsets get appended to
+ * \param level The instruction set to use for classifying characters
+ */
+inline void build_structural_index(char const * begin, std::size_t size, std::vector<uint32_t> & index,
+                                   simd_level level = available_simd_level())
+{
+    block_classifier_function const classify = block_classifier(level);
+
+    index.reserve(index.size() + size / 4);
+    structural_indexer indexer(index);
+    block_masks masks;
+
+    std::size_t offset = 0;
+    for (; offset + 64 <= size; offset += 64)
+    {
+        classify(begin + offset, masks);
+        indexer.add_block(masks, uint32_t(offset));
+    }
+
+    if (offset < size)
+    {
+        // pad the last partial block with whitespace
+        char tail[64];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, begin + offset, size - offset);
+        classify(tail, masks);
+        indexer.add_block(masks, uint32_t(offset));
+    }
+}
+
+} // namespace impl
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_STRUCTURAL_INDEX_HPP__
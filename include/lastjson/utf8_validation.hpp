@@ -0,0 +1,359 @@
+/* Last.json (c) 2012 Sven Over <sven@last.fm>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+
+#ifndef LASTJSON_UTF8_VALIDATION_HPP__
+#define LASTJSON_UTF8_VALIDATION_HPP__
+
+#include <cstddef>
+#include <cstring>
+
+#include "impl_helpers.hpp"
+#include "structural_index.hpp"
+
+namespace lastjson {
+
+namespace impl {
+
+/**
+ * \brief Length of the well-formed UTF-8 sequence at p, or 0 if it is not
+ *
+ * Follows RFC 3629: overlong encodings, surrogates and code points above
+ * U+10FFFF are rejected.
+ */
+inline std::size_t utf8_sequence_length(char const * p, char const * end)
+{
+    unsigned char const * const s = reinterpret_cast<unsigned char const *>(p);
+    std::ptrdiff_t const available = end - p;
+    unsigned char const c = s[0];
+
+    if (c < 0x80)
+    {
+        return 1;
+    }
+
+    if (c < 0xc2)
+    {
+        // a continuation byte, or the lead of an overlong two byte sequence
+        return 0;
+    }
+
+    if (c < 0xe0)
+    {
+        return available >= 2 && (s[1] & 0xc0) == 0x80 ? 2 : 0;
+    }
+
+    if (c < 0xf0)
+    {
+        if (available < 3 || (s[1] & 0xc0) != 0x80 || (s[2] & 0xc0) != 0x80
+            || (c == 0xe0 && s[1] < 0xa0)       // overlong
+            || (c == 0xed && s[1] >= 0xa0))     // surrogate
+        {
+            return 0;
+        }
+
+        return 3;
+    }
+
+    if (c < 0xf5)
+    {
+        if (available < 4 || (s[1] & 0xc0) != 0x80 || (s[2] & 0xc0) != 0x80 || (s[3] & 0xc0) != 0x80
+            || (c == 0xf0 && s[1] < 0x90)       // overlong
+            || (c == 0xf4 && s[1] >= 0x90))     // above U+10FFFF
+        {
+            return 0;
+        }
+
+        return 4;
+    }
+
+    return 0;
+}
+
+/**
+ * \brief Find the first byte of [begin, end) that is not valid UTF-8
+ *
+ * \return The start of the first ill-formed sequence, or end
+ */
+inline char const * validate_utf8_scalar(char const * begin, char const * end)
+{
+    while (begin != end)
+    {
+        std::size_t const length = utf8_sequence_length(begin, end);
+        if (!length)
+        {
+            return begin;
+        }
+
+        begin += length;
+    }
+
+    return end;
+}
+
+#ifdef LASTJSON_SIMD
+
+/**
+ * \brief Skips runs of ASCII 16 bytes at a time, validating the rest per sequence
+ */
+__attribute__((target("sse2")))
+inline char const * validate_utf8_sse2(char const * begin, char const * end)
+{
+    while (end - begin >= 16)
+    {
+        int const mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(begin)));
+        if (!mask)
+        {
+            begin += 16;
+            continue;
+        }
+
+        begin += count_trailing_zeros(uint64_t(mask));
+        while (begin != end && static_cast<unsigned char>(*begin) >= 0x80)
+        {
+            std::size_t const length = utf8_sequence_length(begin, end);
+            if (!length)
+            {
+                return begin;
+            }
+
+            begin += length;
+        }
+    }
+
+    return validate_utf8_scalar(begin, end);
+}
+
+/**
+ * \brief Error classes of two consecutive bytes for the AVX2 validator
+ *
+ * Each class is a bit that is set in three lookup tables, indexed by the
+ * high nibble of the first byte, its low nibble and the high nibble of the
+ * second byte. A pair of bytes is in error if all three lookups have a bit
+ * in common. TWO_CONTS instead marks pairs of continuation bytes, which are
+ * only valid as the third or fourth byte of a sequence.
+ */
+enum utf8_error_class
+{
+    UTF8_TOO_SHORT = 1 << 0,        // lead byte not followed by a continuation
+    UTF8_TOO_LONG = 1 << 1,         // ASCII followed by a continuation
+    UTF8_OVERLONG_3 = 1 << 2,
+    UTF8_TOO_LARGE = 1 << 3,
+    UTF8_SURROGATE = 1 << 4,
+    UTF8_OVERLONG_2 = 1 << 5,
+    UTF8_TOO_LARGE_1000 = 1 << 6,
+    UTF8_OVERLONG_4 = 1 << 6,
+    UTF8_TWO_CONTS = 1 << 7,
+    UTF8_CARRY = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS
+};
+
+__attribute__((target("avx2")))
+inline __m256i utf8_nibble_table(char a0, char a1, char a2, char a3, char a4, char a5, char a6, char a7,
+                                 char a8, char a9, char a10, char a11, char a12, char a13, char a14, char a15)
+{
+    return _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15));
+}
+
+/**
+ * \brief The last n bytes of prev followed by the first 32 - n bytes of input
+ */
+template<int N>
+__attribute__((target("avx2")))
+inline __m256i utf8_previous_bytes(__m256i input, __m256i prev)
+{
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+/**
+ * \brief Error bits of a 32 byte block, given the block before it
+ */
+__attribute__((target("avx2")))
+inline __m256i utf8_block_errors(__m256i input, __m256i prev_input)
+{
+    char const tl = UTF8_TOO_LONG;
+    char const ts = UTF8_TOO_SHORT;
+    char const tc = char(UTF8_TWO_CONTS);
+    char const lg = UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000;
+    char const cont = char(UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS);
+
+    __m256i const byte_1_high = utf8_nibble_table(
+        // 0_______ ________   ASCII
+        tl, tl, tl, tl, tl, tl, tl, tl,
+        // 10______ ________   continuation
+        tc, tc, tc, tc,
+        // 110_____ ________   two byte lead
+        ts | UTF8_OVERLONG_2, ts,
+        // 1110____ ________   three byte lead
+        ts | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        // 1111____ ________   four byte lead
+        ts | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+
+    char const carry = char(UTF8_CARRY);
+    __m256i const byte_1_low = utf8_nibble_table(
+        carry | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        carry | UTF8_OVERLONG_2,
+        carry, carry,
+        carry | UTF8_TOO_LARGE,
+        carry | lg, carry | lg, carry | lg, carry | lg, carry | lg, carry | lg, carry | lg, carry | lg,
+        carry | lg | UTF8_SURROGATE,
+        carry | lg, carry | lg);
+
+    __m256i const byte_2_high = utf8_nibble_table(
+        // ________ 0_______   ASCII
+        ts, ts, ts, ts, ts, ts, ts, ts,
+        // ________ 1000____
+        cont | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        // ________ 1001____
+        cont | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        // ________ 101_____
+        cont | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        cont | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        // ________ 11______   lead
+        ts, ts, ts, ts);
+
+    __m256i const low_nibble = _mm256_set1_epi8(0x0f);
+    __m256i const prev1 = utf8_previous_bytes<1>(input, prev_input);
+    __m256i const special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble)),
+            _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, low_nibble))),
+        _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble)));
+
+    // the third and fourth byte of a sequence must be continuations, which
+    // is what TWO_CONTS has to match exactly
+    __m256i const third = _mm256_subs_epu8(utf8_previous_bytes<2>(input, prev_input), _mm256_set1_epi8(0xe0 - 0x80));
+    __m256i const fourth = _mm256_subs_epu8(utf8_previous_bytes<3>(input, prev_input), _mm256_set1_epi8(0xf0 - 0x80));
+    __m256i const must_be_continuation = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+
+    return _mm256_xor_si256(must_be_continuation, special);
+}
+
+/**
+ * \brief Validates 32 bytes at a time with nibble lookup tables
+ *
+ * After Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction
+ * Per Byte". Blocks of ASCII are only checked for a sequence left
+ * incomplete by the block before. Once a block is found in error, the
+ * exact position is determined by the scalar validator.
+ */
+__attribute__((target("avx2")))
+inline char const * validate_utf8_avx2(char const * begin, char const * end)
+{
+    // nonzero in the last three bytes if they start a sequence that
+    // extends beyond the block
+    __m256i const incomplete_limit = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        char(0xf0 - 1), char(0xe0 - 1), char(0xc0 - 1));
+
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    char tail[32];
+    char const * block = begin;
+
+    for (; block < end; block += 32)
+    {
+        __m256i input;
+        if (end - block >= 32)
+        {
+            input = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(block));
+        }
+        else
+        {
+            // pad the last partial block with NUL, which is ASCII
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, block, end - block);
+            input = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(tail));
+        }
+
+        if (!_mm256_movemask_epi8(input))
+        {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            error = _mm256_or_si256(error, utf8_block_errors(input, prev_input));
+            prev_incomplete = _mm256_subs_epu8(input, incomplete_limit);
+        }
+
+        prev_input = input;
+        if (!_mm256_testz_si256(error, error))
+        {
+            break;
+        }
+    }
+
+    if (_mm256_testz_si256(error, error) && _mm256_testz_si256(prev_incomplete, prev_incomplete))
+    {
+        return end;
+    }
+
+    if (block >= end)
+    {
+        block -= 32;
+    }
+
+    // everything before the block is valid, so the first byte within its
+    // last three bytes that is not a continuation starts a sequence
+    char const * it = block - (block - begin < 3 ? block - begin : 3);
+    while (it != block && (static_cast<unsigned char>(*it) & 0xc0) == 0x80)
+    {
+        ++it;
+    }
+
+    return validate_utf8_scalar(it, end);
+}
+
+#endif // ifdef LASTJSON_SIMD
+
+/**
+ * \brief Find the first byte of [begin, end) that is not valid UTF-8
+ *
+ * \param level The instruction set to use
+ * \return The start of the first ill-formed sequence, or end
+ */
+inline char const * validate_utf8(char const * begin, char const * end,
+                                  simd_level level = available_simd_level())
+{
+#ifdef LASTJSON_SIMD
+    if (level >= SIMD_AVX2)
+    {
+        return validate_utf8_avx2(begin, end);
+    }
+    else if (level >= SIMD_SSE2)
+    {
+        return validate_utf8_sse2(begin, end);
+    }
+#else
+    (void) level;
+#endif
+
+    return validate_utf8_scalar(begin, end);
+}
+
+} // namespace impl
+} // namespace lastjson
+
+#endif // ifndef LASTJSON_UTF8_VALIDATION_HPP__
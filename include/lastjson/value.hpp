@@ -88,6 +88,47 @@ inline char const * jsontype_name(jsontype t)
 template<class>
 class basic_value;
 
+namespace impl {
+
+/**
+ * \brief Unparsed JSON array or object held by a lazily parsed value
+ *
+ * The subtree keeps the buffer it was sliced from alive. It is parsed on
+ * first access, after which the slice is no longer needed, and the parsed
+ * array or object is shared by all values referring to this subtree.
+ */
+struct lazy_subtree
+{
+    typedef void (*parse_function)(lazy_subtree &);
+
+    /// Owner of the buffer [begin, end) points into
+    shared_ptr<void const> buffer;
+    char const * begin;
+    char const * end;
+
+    /// Nesting depth still allowed within the subtree
+    std::size_t max_depth;
+
+    /// Parses [begin, end) and stores the result in parsed
+    parse_function parse;
+
+    /// The parsed array_type or object_type, once accessed
+    shared_ptr<void> parsed;
+
+    shared_ptr<void> const & get()
+    {
+        if (!parsed)
+        {
+            parse(*this);
+            buffer.reset();
+        }
+
+        return parsed;
+    }
+};
+
+} // namespace impl
+
 /**
  * \brief Standard properties for the value type
  *
@@ -169,12 +210,13 @@ public:
     /// Default constructor, evaluates as JSON null value
     basic_value()
         : m_type(JSONNULL)
+        , m_storage(OWNED)
     {
     }
 
     /// Constructor for JSON booleans (from bool_type)
     basic_value(bool_type v)
-        : m_data((simple_data){ boolean : v }), m_type(BOOL)
+        : m_data((simple_data){ boolean : v }), m_type(BOOL), m_storage(OWNED)
     {
     }
 
@@ -182,6 +224,7 @@ public:
     basic_value(unsigned char v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -189,6 +232,7 @@ public:
     basic_value(signed char v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -196,6 +240,7 @@ public:
     basic_value(unsigned short v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -203,6 +248,7 @@ public:
     basic_value(signed short v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -210,6 +256,7 @@ public:
     basic_value(unsigned int v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -217,6 +264,7 @@ public:
     basic_value(signed int v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -224,6 +272,7 @@ public:
     basic_value(unsigned long v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -231,6 +280,7 @@ public:
     basic_value(signed long v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
@@ -238,19 +288,22 @@ public:
     basic_value(unsigned long long v)
         : m_data((simple_data){ integer : v })
         , m_type(INT)
+        , m_storage(OWNED)
     {
     }
 
     /// Constructor for JSON integers (from signed long long)
     basic_value(signed long long v)
         : m_data((simple_data){ integer : v })
-        , m_type(INT) {
+        , m_type(INT)
+        , m_storage(OWNED) {
     }
 
     /// Constructor for JSON floating point numbers
     basic_value(float_type v)
         : m_data((simple_data){ floatingpoint : v })
         , m_type(FLOAT)
+        , m_storage(OWNED)
     {
     }
 
@@ -258,6 +311,7 @@ public:
     basic_value(string_type const & v)
         : m_ptr(new string_type(v))
         , m_type(STRING)
+        , m_storage(OWNED)
     {
     }
 
@@ -265,6 +319,7 @@ public:
     basic_value(typename string_type::const_iterator begin, typename string_type::const_iterator end)
         : m_ptr(new string_type(begin, end))
         , m_type(STRING)
+        , m_storage(OWNED)
     {
     }
 
@@ -272,6 +327,7 @@ public:
     basic_value(char const * v)
         : m_ptr(new string_type(v))
         , m_type(STRING)
+        , m_storage(OWNED)
     {
     }
 
@@ -279,6 +335,7 @@ public:
     basic_value(string_pointer const & v)
         : m_ptr(v)
         , m_type(STRING)
+        , m_storage(OWNED)
     {
         if (!m_ptr)
         {
@@ -290,6 +347,7 @@ public:
     basic_value(array_type const & v)
         : m_ptr(new array_type(v))
         , m_type(ARRAY)
+        , m_storage(OWNED)
     {
     }
 
@@ -298,12 +356,13 @@ public:
     basic_value(std::vector<Value> const & v)
         : m_ptr(new array_type(v.begin(), v.end()))
         , m_type(ARRAY)
+        , m_storage(OWNED)
     {
     }
 
     /// Constructor for JSON arrays (referencing existing array object)
     basic_value(array_pointer const & v)
-        : m_ptr(v), m_type(ARRAY)
+        : m_ptr(v), m_type(ARRAY), m_storage(OWNED)
     {
         if (!m_ptr)
         {
@@ -313,20 +372,20 @@ public:
 
     /// Constructor for JSON objects
     basic_value(object_type const & v)
-        : m_ptr(new object_type(v)), m_type(OBJECT)
+        : m_ptr(new object_type(v)), m_type(OBJECT), m_storage(OWNED)
     {
     }
 
     /// Constructor for JSON objects (from std::map)
     template<typename Key, typename Value>
     basic_value(std::map<Key, Value> const & v)
-        : m_ptr(new object_type(v.begin(), v.end())), m_type(OBJECT)
+        : m_ptr(new object_type(v.begin(), v.end())), m_type(OBJECT), m_storage(OWNED)
     {
     }
 
     /// Constructor for JSON objects (referencing existing array object)
     basic_value(object_pointer const & v)
-        : m_ptr(v), m_type(OBJECT)
+        : m_ptr(v), m_type(OBJECT), m_storage(OWNED)
     {
         if (!m_ptr)
         {
@@ -334,6 +393,58 @@ public:
         }
     }
 
+    /**
+     * \brief Constructor for JSON strings (referencing data in a shared buffer)
+     *
+     * The value shares ownership of buffer, which must hold [begin, end),
+     * instead of copying the data. A string_type object is only created
+     * when one is asked for, e.g. by get_string().
+     */
+    basic_value(shared_ptr<void const> const & buffer, char const * begin, char const * end)
+        : m_ptr(buffer, const_cast<char *>(begin))
+        , m_type(STRING)
+        , m_storage(SLICE)
+    {
+        m_data.integer = end - begin;
+    }
+
+    /**
+     * \brief Constructors for JSON numbers remembering their text
+     *
+     * text points to the number as it appeared in the input, within a
+     * buffer the value shares ownership of. The text ends at the first
+     * character that cannot be part of a number. write_json() copies it
+     * instead of formatting v.
+     */
+    basic_value(int_type v, shared_ptr<void const> const & buffer, char const * text)
+        : m_ptr(buffer, const_cast<char *>(text))
+        , m_type(INT)
+        , m_storage(LEXEME)
+    {
+        m_data.integer = v;
+    }
+
+    basic_value(float_type v, shared_ptr<void const> const & buffer, char const * text)
+        : m_ptr(buffer, const_cast<char *>(text))
+        , m_type(FLOAT)
+        , m_storage(LEXEME)
+    {
+        m_data.floatingpoint = v;
+    }
+
+    /**
+     * \brief Constructor for lazily parsed JSON arrays and objects
+     *
+     * This is used by lastjson::parse_lazy. The subtree is parsed on first
+     * access to its contents.
+     */
+    basic_value(jsontype type, shared_ptr<impl::lazy_subtree> const & subtree)
+        : m_ptr(subtree)
+        , m_type(type)
+        , m_storage(LAZY)
+    {
+    }
+
 /* ***************************************************************************
  *
  *  JSON formatting
@@ -387,6 +498,7 @@ public:
         m_ptr.swap(other.m_ptr);
         std::swap(m_data, other.m_data);
         std::swap(m_type, other.m_type);
+        std::swap(m_storage, other.m_storage);
     }
 
 /* ***************************************************************************
@@ -475,6 +587,34 @@ public:
         return m_type == OBJECT;
     }
 
+    /**
+     * \brief Check whether this is an array or object that is not parsed yet
+     *
+     * Values returned by lastjson::parse_lazy defer parsing of deeply nested
+     * arrays and objects until their contents are first accessed.
+     *
+     * \return Boolean indicating whether parsing of this value is pending
+     */
+    bool is_lazy() const
+    {
+        return m_storage == LAZY && !lazy_ref().parsed;
+    }
+
+    /**
+     * \brief Check whether this value's string, array or object is its own
+     *
+     * Copies of a value share its string, array or object data, so changes
+     * through e.g. get_array_ref() are seen by all of them unless this
+     * returns true.
+     *
+     * \return Boolean indicating whether this is a string, array or object
+     * whose data no other value refers to
+     */
+    bool is_unique() const
+    {
+        return m_storage == OWNED && m_ptr && m_ptr.use_count() == 1;
+    }
+
 /* ***************************************************************************
  *
  *  Basic getter methods
@@ -505,7 +645,7 @@ public:
             return m_data.floatingpoint;
 
         case STRING:
-            return !string_ref_dangerous().empty();
+            return m_storage == SLICE ? m_data.integer != 0 : !string_ref_dangerous().empty();
 
         case ARRAY:
             return !array_ref_dangerous().empty();
@@ -574,6 +714,7 @@ public:
     {
         if (m_type == INT)
         {
+            forget_number_text();
             return m_data.integer;
         }
         else
@@ -619,6 +760,7 @@ public:
     {
         if (m_type == FLOAT)
         {
+            forget_number_text();
             return m_data.floatingpoint;
         }
         else
@@ -679,6 +821,7 @@ public:
     {
         if (m_type == STRING)
         {
+            own_string();
             return static_pointer_cast<string_type>(m_ptr);
         }
         else
@@ -687,6 +830,66 @@ public:
         }
     }
 
+    /**
+     * \brief Get the character data of a string
+     *
+     * Unlike get_string(), this does not create a string_type object for
+     * strings that reference a shared buffer. This method throws if this
+     * value object is not of type string.
+     *
+     * \param begin Set to the first character of the string
+     * \param end Set to one past the last character of the string
+     */
+    void get_string_range(char const * & begin, char const * & end) const
+    {
+        if (m_type != STRING)
+        {
+            throw type_error("Cannot convert "+std::string(jsontype_name(m_type))+" to string");
+        }
+
+        if (m_storage == SLICE)
+        {
+            begin = static_cast<char const *>(m_ptr.get());
+            end = begin + m_data.integer;
+        }
+        else
+        {
+            string_type const & str = string_ref_dangerous();
+            begin = str.data();
+            end = begin + str.size();
+        }
+    }
+
+    /**
+     * \brief Get the text a number was parsed from
+     *
+     * The text is only known for numbers parsed with
+     * parse_options::raw_numbers set, until they are changed through
+     * get_int_ref() or get_float_ref().
+     *
+     * \param begin Set to the first character of the number
+     * \param end Set to one past the last character of the number
+     *
+     * \return Boolean indicating whether the text is known
+     */
+    bool get_number_text(char const * & begin, char const * & end) const
+    {
+        if (m_storage != LEXEME)
+        {
+            return false;
+        }
+
+        begin = static_cast<char const *>(m_ptr.get());
+        end = begin;
+        while ((*end >= '0' && *end <= '9') || *end == '.' || *end == 'e' || *end == 'E'
+               || *end == '+' || *end == '-')
+        {
+            ++end;
+        }
+
+        return true;
+    }
+
     /**
      * \brief Return const-reference to array
      *
@@ -739,6 +942,7 @@ public:
     {
         if (m_type == ARRAY)
         {
+            resolve_lazy();
             return static_pointer_cast<array_type>(m_ptr);
         }
         else
@@ -799,6 +1003,7 @@ public:
     {
         if (m_type == OBJECT)
         {
+            resolve_lazy();
             return static_pointer_cast<object_type>(m_ptr);
         }
         else
@@ -925,21 +1130,25 @@ public:
         {
         case JSONNULL:
             m_type = JSONNULL;
+            m_storage = OWNED;
             m_ptr.reset();
             return *this;
 
         case BOOL:
             m_type = BOOL;
+            m_storage = OWNED;
             m_data.boolean = other.m_data.boolean;
             return *this;
 
         case INT:
             m_type = INT;
+            m_storage = OWNED;
             m_data.integer = other.m_data.integer;
             return *this;
 
         case FLOAT:
             m_type = FLOAT;
+            m_storage = OWNED;
             m_data.floatingpoint = other.m_data.floatingpoint;
             return *this;
 
@@ -1276,7 +1485,7 @@ public:
 private:
     typedef shared_ptr<void> void_pointer;
 
-    void_pointer m_ptr;
+    mutable void_pointer m_ptr;
     union simple_data
     {
         int_type integer;
@@ -1285,6 +1494,70 @@ private:
     } m_data;
     jsontype m_type;
 
+    /// What m_ptr points to
+    enum storage
+    {
+        OWNED,  // a string_type, array_type or object_type
+        LAZY,   // an impl::lazy_subtree
+        SLICE,  // string data within a shared buffer, m_data.integer bytes long
+        LEXEME  // the text of a number within a shared buffer
+    };
+
+    mutable storage m_storage;
+
+    void forget_number_text()
+    {
+        if (m_storage == LEXEME)
+        {
+            m_ptr.reset();
+            m_storage = OWNED;
+        }
+    }
+
+    impl::lazy_subtree & lazy_ref() const
+    {
+        return *static_cast<impl::lazy_subtree *>(m_ptr.get());
+    }
+
+    /**
+     * \brief Return the pointer to array or object data, parsing it if needed
+     */
+    void_pointer const & container_ptr() const
+    {
+        return m_storage == LAZY ? lazy_ref().get() : m_ptr;
+    }
+
+    /**
+     * \brief Parse a lazy subtree and drop the reference to it
+     */
+    void resolve_lazy()
+    {
+        if (m_storage == LAZY)
+        {
+            void_pointer parsed = lazy_ref().get();
+            m_ptr.swap(parsed);
+            m_storage = OWNED;
+        }
+    }
+
+    /**
+     * \brief Copy string data out of a shared buffer into a string of its own
+     *
+     * This is done on first access to the string_type object, and so also
+     * from const methods.
+     */
+    void own_string() const
+    {
+        if (m_storage == SLICE)
+        {
+            char const * const data = static_cast<char const *>(m_ptr.get());
+            string_pointer str(new string_type);
+            str->assign(data, data + m_data.integer);
+            m_ptr = str;
+            m_storage = OWNED;
+        }
+    }
+
     /**
      * \brief Return string const-reference
      *
@@ -1294,6 +1567,7 @@ private:
      */
     string_type const & string_ref_dangerous() const
     {
+        own_string();
         return *static_cast<string_type const *>(m_ptr.get());
     }
 
@@ -1306,6 +1580,7 @@ private:
      */
     string_type & string_ref_dangerous()
     {
+        own_string();
         return *static_cast<string_type *>(m_ptr.get());
     }
 
@@ -1318,7 +1593,7 @@ private:
      */
     array_type const & array_ref_dangerous() const
     {
-        return *static_cast<array_type const *>(m_ptr.get());
+        return *static_cast<array_type const *>(container_ptr().get());
     }
 
     /**
@@ -1330,6 +1605,7 @@ private:
      */
     array_type & array_ref_dangerous()
     {
+        resolve_lazy();
         return *static_cast<array_type *>(m_ptr.get());
     }
 
@@ -1342,7 +1618,7 @@ private:
      */
     object_type const & object_ref_dangerous() const
     {
-        return *static_cast<object_type const *>(m_ptr.get());
+        return *static_cast<object_type const *>(container_ptr().get());
     }
 
     /**
@@ -1354,6 +1630,7 @@ private:
      */
     object_type & object_ref_dangerous()
     {
+        resolve_lazy();
         return *static_cast<object_type *>(m_ptr.get());
     }
 };
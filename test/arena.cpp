@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/arena.hpp>
+
+BOOST_AUTO_TEST_SUITE( arena_test )
+
+namespace {
+class Arena_TestSuite
+{
+public:
+  static std::string roundtrip(std::string const & json)
+  {
+      lastjson::arena a(4096);
+      lastjson::arena_scope scope(a);
+      return lastjson::stringify(lastjson::parse<lastjson::arena_value>(json));
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(parse_, Arena_TestSuite)
+{
+    char const * const docs[] =
+    {
+        "null",
+        "[1,2.5,\"x\",true,false,null,[],{}]",
+        "{\"a\":[1,{\"b\":\"a string too long for the small string buffer\"}],\"c\":{\"d\":\"e\\n\"}}",
+        "\"\\u20ac\"",
+    };
+
+    for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+    {
+        BOOST_CHECK_EQUAL(roundtrip(docs[i]), lastjson::stringify(lastjson::parse(docs[i])));
+    }
+
+    std::string big = "[";
+    for (int i = 0; i < 2000; ++i)
+    {
+        big += i ? ",{\"id\":" : "{\"id\":";
+        big += lastjson::stringify(i) + ",\"tags\":[\"one\",\"two\"],\"name\":\"item number " + lastjson::stringify(i) + "\"}";
+    }
+    big += "]";
+    BOOST_CHECK_EQUAL(roundtrip(big), lastjson::stringify(lastjson::parse(big)));
+}
+
+BOOST_FIXTURE_TEST_CASE(allocation_, Arena_TestSuite)
+{
+    lastjson::arena a;
+    {
+        lastjson::arena_scope scope(a);
+        BOOST_CHECK(lastjson::arena::current() == &a);
+
+        lastjson::arena_value v = lastjson::parse<lastjson::arena_value>("{\"list\": [1, 2], \"name\": \"x\"}");
+        BOOST_CHECK(v.get_object().get_allocator().get_arena() == &a);
+        BOOST_CHECK(v["list"].get_array().get_allocator().get_arena() == &a);
+        BOOST_CHECK(v["name"].get_string().get_allocator().get_arena() == &a);
+
+        v["list"].get_array_ref().push_back(lastjson::arena_value("three"));
+        v["added"] = "a string too long for the small string buffer";
+        BOOST_CHECK_EQUAL(lastjson::stringify(v),
+                          "{\"added\":\"a string too long for the small string buffer\","
+                          "\"list\":[1,2,\"three\"],\"name\":\"x\"}");
+        BOOST_CHECK_EQUAL(v["name"].get_string().str(), "x");
+        BOOST_CHECK_EQUAL(a.capacity(), std::size_t(lastjson::arena::default_block_size));
+    }
+
+    BOOST_CHECK(lastjson::arena::current() == 0);
+    a.release();
+    BOOST_CHECK_EQUAL(a.capacity(), std::size_t(lastjson::arena::default_block_size));
+
+    // without a current arena, memory comes from the heap
+    lastjson::arena_value heap = lastjson::parse<lastjson::arena_value>("[\"x\", {\"y\": 1}]");
+    BOOST_CHECK(heap.get_array().get_allocator().get_arena() == 0);
+    BOOST_CHECK_EQUAL(lastjson::stringify(heap), "[\"x\",{\"y\":1}]");
+}
+
+BOOST_FIXTURE_TEST_CASE(arena_, Arena_TestSuite)
+{
+    lastjson::arena a(1024);
+    char * const p = static_cast<char *>(a.allocate(3, 1));
+    char * const q = static_cast<char *>(a.allocate(8, 8));
+    BOOST_CHECK(q >= p + 3 && q < p + 16);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(q) % 8, 0u);
+    BOOST_CHECK_EQUAL(a.capacity(), 1024u);
+
+    // large allocations get blocks of their own, leaving the current one
+    a.allocate(5000, 8);
+    BOOST_CHECK_EQUAL(a.capacity(), 1024u + 5008u);
+    char * const r = static_cast<char *>(a.allocate(8, 8));
+    BOOST_CHECK(r == q + 8);
+
+    a.release();
+    BOOST_CHECK_EQUAL(a.capacity(), 1024u);
+    BOOST_CHECK(a.allocate(3, 1) == p);
+
+    lastjson::arena b;
+    {
+        lastjson::arena_scope outer(a);
+        {
+            lastjson::arena_scope inner(b);
+            BOOST_CHECK(lastjson::arena::current() == &b);
+        }
+        BOOST_CHECK(lastjson::arena::current() == &a);
+    }
+    BOOST_CHECK(lastjson::arena::current() == 0);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
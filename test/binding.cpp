@@ -0,0 +1,156 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <lastjson/binding.hpp>
+
+namespace binding_test_types {
+
+struct artist
+{
+    std::string name;
+    unsigned int listeners;
+};
+
+struct track
+{
+    track()
+        : timestamp(0)
+        , duration(0)
+        , loved(false)
+    {
+    }
+
+    artist by;
+    std::string title;
+    lastjson::int64_t timestamp;
+    double duration;
+    bool loved;
+    std::vector<std::string> tags;
+    lastjson::value extra;
+};
+
+struct playlist
+{
+    std::string name;
+    std::vector<track> tracks;
+};
+
+}
+
+LASTJSON_BIND_BEGIN(binding_test_types::artist)
+    LASTJSON_BIND_FIELD(name)
+    LASTJSON_BIND_FIELD(listeners)
+LASTJSON_BIND_END()
+
+LASTJSON_BIND_BEGIN(binding_test_types::track)
+    LASTJSON_BIND_FIELD_AS(by, "artist")
+    LASTJSON_BIND_FIELD(title)
+    LASTJSON_BIND_FIELD_AS(timestamp, "ts")
+    LASTJSON_BIND_FIELD(duration)
+    LASTJSON_BIND_FIELD(loved)
+    LASTJSON_BIND_FIELD(tags)
+    LASTJSON_BIND_FIELD(extra)
+LASTJSON_BIND_END()
+
+LASTJSON_BIND_BEGIN(binding_test_types::playlist)
+    LASTJSON_BIND_FIELD(name)
+    LASTJSON_BIND_FIELD(tracks)
+LASTJSON_BIND_END()
+
+BOOST_AUTO_TEST_SUITE( binding_test )
+
+namespace {
+class Binding_TestSuite
+{
+public:
+  typedef binding_test_types::track track;
+  typedef binding_test_types::playlist playlist;
+};
+
+BOOST_FIXTURE_TEST_CASE(parse_, Binding_TestSuite)
+{
+    track t;
+    lastjson::parse_struct(
+        " {\"title\": \"A \\\"Song\\\"\", \"ts\": 1500000000123, \"duration\": 215,"
+        "  \"unknown\": {\"deep\": [1, {\"x\": \"}\"}]}, \"loved\": true,"
+        "  \"artist\": {\"name\": \"Band\", \"listeners\": 42},"
+        "  \"tags\": [\"rock\", \"indie\"], \"extra\": {\"a\": [null]}, \"t\\u0061gs\": [\"pop\"]} ", t);
+
+    BOOST_CHECK_EQUAL(t.title, "A \"Song\"");
+    BOOST_CHECK_EQUAL(t.timestamp, 1500000000123LL);
+    BOOST_CHECK_EQUAL(t.duration, 215.0);
+    BOOST_CHECK(t.loved);
+    BOOST_CHECK_EQUAL(t.by.name, "Band");
+    BOOST_CHECK_EQUAL(t.by.listeners, 42u);
+    BOOST_REQUIRE_EQUAL(t.tags.size(), 1u);
+    BOOST_CHECK_EQUAL(t.tags[0], "pop");
+    BOOST_CHECK_EQUAL(lastjson::stringify(t.extra), "{\"a\":[null]}");
+
+    // missing and null members keep their values
+    lastjson::parse_struct("{\"title\": null, \"loved\": false}", t);
+    BOOST_CHECK_EQUAL(t.title, "A \"Song\"");
+    BOOST_CHECK(!t.loved);
+    BOOST_CHECK_EQUAL(t.by.listeners, 42u);
+
+    playlist p;
+    lastjson::parse_struct("{\"tracks\": [{\"title\": \"one\"}, {\"title\": \"two\", \"tags\": []}], \"name\": \"mix\"}", p);
+    BOOST_CHECK_EQUAL(p.name, "mix");
+    BOOST_REQUIRE_EQUAL(p.tracks.size(), 2u);
+    BOOST_CHECK_EQUAL(p.tracks[1].title, "two");
+    lastjson::parse_struct("{\"tracks\": []}", p);
+    BOOST_CHECK(p.tracks.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(write_, Binding_TestSuite)
+{
+    track t;
+    t.by.name = "Band";
+    t.by.listeners = 7;
+    t.title = "line\nbreak";
+    t.timestamp = 12;
+    t.duration = 1.5;
+    t.tags.push_back("x");
+    std::string const json = lastjson::stringify(t);
+    BOOST_CHECK_EQUAL(json, "{\"artist\":{\"name\":\"Band\",\"listeners\":7},\"title\":\"line\\nbreak\","
+                            "\"ts\":12,\"duration\":1.5,\"loved\":false,\"tags\":[\"x\"],\"extra\":null}");
+
+    // the same as going through a value
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse(json)["artist"]), "{\"listeners\":7,\"name\":\"Band\"}");
+
+    playlist p;
+    p.tracks.push_back(t);
+    playlist q;
+    lastjson::parse_struct(lastjson::stringify(p), q);
+    BOOST_CHECK_EQUAL(lastjson::stringify(q), lastjson::stringify(p));
+    BOOST_CHECK_EQUAL(lastjson::stringify(playlist()), "{\"name\":\"\",\"tracks\":[]}");
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, Binding_TestSuite)
+{
+    track t;
+    BOOST_CHECK_THROW(lastjson::parse_struct("", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"title\": \"x\"", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"title\" \"x\"}", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"title\": \"x\",}", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"tags\": [\"x\" \"y\"]}", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{} {}", t), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"artist\": {\"listeners\": -1}}", t), lastjson::parser_error);
+
+    BOOST_CHECK_THROW(lastjson::parse_struct("[]", t), lastjson::type_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"title\": 5}", t), lastjson::type_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"ts\": 1.5}", t), lastjson::type_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"loved\": \"yes\"}", t), lastjson::type_error);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"tags\": {}}", t), lastjson::type_error);
+
+    lastjson::parse_options options;
+    options.max_depth = 3;
+    playlist p;
+    lastjson::parse_struct("{\"tracks\": [{}]}", p, options);
+    BOOST_CHECK_THROW(lastjson::parse_struct("{\"tracks\": [{\"artist\": {}}]}", p, options),
+                      lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
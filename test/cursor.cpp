@@ -0,0 +1,129 @@
+#include <boost/test/unit_test.hpp>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/cursor.hpp>
+
+BOOST_AUTO_TEST_SUITE( cursor_test )
+
+namespace {
+class Cursor_TestSuite
+{
+public:
+  static std::string const & document()
+  {
+      static std::string const doc =
+          "{\"meta\": {\"skip\": [1, [2, {\"}\": \"]\"}], \"x\\\"y\"], \"n\": null},"
+          " \"user\": {\"name\": \"J\\u00f6rg\", \"id\": 42, \"score\": -1.5e2,"
+          "           \"tags\": [\"a\", \"b\\n\", \"c\"], \"active\": true},"
+          " \"caf\\u00e9\": 7, \"tail\": [[], {}, 3]}";
+      return doc;
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(navigation_, Cursor_TestSuite)
+{
+    lastjson::cursor c(document());
+    BOOST_CHECK_EQUAL(c.type(), lastjson::OBJECT);
+    BOOST_REQUIRE(c.find_field("user"));
+    BOOST_REQUIRE(c.find_field("id"));
+    BOOST_CHECK_EQUAL(c.type(), lastjson::INT);
+    BOOST_CHECK_EQUAL(c.get_int(), 42);
+    BOOST_REQUIRE(c.find_field("tags"));
+    BOOST_CHECK_EQUAL(c.depth(), 2u);
+
+    std::string all;
+    while (c.next_element())
+    {
+        all += c.get_string() + "|";
+    }
+    BOOST_CHECK_EQUAL(all, "a|b\n|c|");
+
+    BOOST_REQUIRE(c.find_field("active"));
+    BOOST_CHECK(c.get_bool());
+    BOOST_CHECK(!c.find_field("missing"));
+    BOOST_CHECK_EQUAL(c.depth(), 1u);
+
+    // keys are compared after unescaping
+    BOOST_REQUIRE(c.find_field("caf\xc3\xa9"));
+    BOOST_CHECK_EQUAL(c.get_float(), 7.0);
+    BOOST_REQUIRE(c.find_field("tail"));
+    BOOST_CHECK_EQUAL(lastjson::stringify(c.get_value()), "[[],{},3]");
+    BOOST_CHECK(!c.find_field("user"));
+    BOOST_CHECK_EQUAL(c.depth(), 0u);
+    BOOST_CHECK(c.at_end());
+}
+
+BOOST_FIXTURE_TEST_CASE(values_, Cursor_TestSuite)
+{
+    lastjson::cursor c(document());
+    BOOST_REQUIRE(c.find_field("meta"));
+    BOOST_REQUIRE(c.find_field("n"));
+    BOOST_CHECK(c.is_null());
+
+    lastjson::cursor u(document());
+    BOOST_REQUIRE(u.find_field("user"));
+    BOOST_REQUIRE(u.find_field("name"));
+    char const * a;
+    char const * b;
+    u.get_raw_string(a, b);
+    BOOST_CHECK_EQUAL(std::string(a, b), "J\\u00f6rg");
+    BOOST_REQUIRE(u.find_field("score"));
+    BOOST_CHECK_EQUAL(u.type(), lastjson::FLOAT);
+    BOOST_CHECK_THROW(u.get_int(), lastjson::type_error);
+
+    lastjson::cursor v(document());
+    BOOST_REQUIRE(v.find_field("user"));
+    BOOST_REQUIRE(v.find_field("score"));
+    BOOST_CHECK_EQUAL(v.get_float(), -150.0);
+    BOOST_REQUIRE(v.find_field("tags"));
+    BOOST_REQUIRE(v.next_element());
+    v.skip();
+    BOOST_REQUIRE(v.next_element());
+    BOOST_CHECK_EQUAL(v.get_string(), "b\n");
+
+    lastjson::cursor w("[1, [2, 3], 4]", std::size_t(14));
+    BOOST_REQUIRE(w.next_element());
+    BOOST_CHECK(!w.is_null());
+    w.skip();
+    BOOST_REQUIRE(w.next_element());
+    BOOST_REQUIRE(w.next_element());
+    BOOST_CHECK_EQUAL(w.get_int(), 2);
+    BOOST_REQUIRE(w.next_element());
+    BOOST_CHECK_EQUAL(w.get_int(), 3);
+    BOOST_CHECK(!w.next_element());
+    BOOST_REQUIRE(w.next_element());
+    BOOST_CHECK_EQUAL(w.get_int(), 4);
+    BOOST_CHECK(!w.next_element());
+    BOOST_CHECK(w.at_end());
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, Cursor_TestSuite)
+{
+    lastjson::cursor c("[1]");
+    BOOST_CHECK_THROW(c.find_field("a"), lastjson::type_error);
+    BOOST_REQUIRE(c.next_element());
+    BOOST_CHECK_THROW(c.get_string(), lastjson::type_error);
+    BOOST_CHECK_THROW(c.get_bool(), lastjson::type_error);
+
+    lastjson::cursor d("{\"a\": [1, 2}");
+    BOOST_CHECK_THROW(d.find_field("b"), lastjson::parser_error);
+
+    lastjson::cursor e("{\"a\": 12x}");
+    BOOST_REQUIRE(e.find_field("a"));
+    BOOST_CHECK_THROW(e.get_int(), lastjson::parser_error);
+
+    lastjson::cursor f("{\"a\": tru}");
+    BOOST_CHECK_THROW(f.find_field("b"), lastjson::parser_error);
+
+    lastjson::cursor g("{\"a\": 1");
+    BOOST_REQUIRE(g.find_field("a"));
+    BOOST_CHECK_EQUAL(g.get_int(), 1);
+    BOOST_CHECK_THROW(g.find_field("b"), lastjson::parser_error);
+
+    std::string deep(2000, '[');
+    lastjson::cursor h(deep);
+    BOOST_CHECK_THROW(while (h.next_element()) {}, lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,96 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/document_stream.hpp>
+
+BOOST_AUTO_TEST_SUITE( document_stream_test )
+
+namespace {
+class DocumentStream_TestSuite
+{
+public:
+  // stringify all documents of json, separated by '|'
+  static std::string docs(std::string const & json)
+  {
+      std::string result;
+      lastjson::document_stream stream(json);
+      for (lastjson::document_stream::iterator it = stream.begin(); it != stream.end(); ++it)
+      {
+          result += result.empty() ? "" : "|";
+          result += lastjson::stringify(*it);
+      }
+
+      return result;
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(documents_, DocumentStream_TestSuite)
+{
+    BOOST_CHECK_EQUAL(docs(""), "");
+    BOOST_CHECK_EQUAL(docs(" \n "), "");
+    BOOST_CHECK_EQUAL(docs("{\"a\":1}"), "{\"a\":1}");
+    BOOST_CHECK_EQUAL(docs("{\"a\":1}{\"a\":2}[3]\"x\"[]{}"), "{\"a\":1}|{\"a\":2}|[3]|\"x\"|[]|{}");
+    BOOST_CHECK_EQUAL(docs("1 2\n3\t\"four\" true null "), "1|2|3|\"four\"|true|null");
+    BOOST_CHECK_EQUAL(docs("\n{\"a\": [1, {\"b\": null}]}\n{\"a\": []}\n"), "{\"a\":[1,{\"b\":null}]}|{\"a\":[]}");
+}
+
+BOOST_FIXTURE_TEST_CASE(next_, DocumentStream_TestSuite)
+{
+    std::string const json = "[1] {\"k\": \"v\"}  ";
+    lastjson::document_stream stream(json.data(), json.data() + json.size());
+
+    lastjson::value v;
+    BOOST_CHECK(stream.next(v));
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "[1]");
+    BOOST_CHECK(stream.position() == json.data() + 3);
+    BOOST_CHECK(stream.next(v));
+    BOOST_CHECK_EQUAL(v["k"].get_string(), "v");
+    BOOST_CHECK(!stream.next(v));
+    BOOST_CHECK_EQUAL(v["k"].get_string(), "v");
+    BOOST_CHECK(stream.position() == json.data() + json.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(shared_, DocumentStream_TestSuite)
+{
+    lastjson::parse_options options;
+    options.raw_numbers = true;
+    lastjson::shared_ptr<std::string const> const buffer(new std::string("[1.50, \"abc\"] 2.0\"x\" 7"));
+    lastjson::document_stream stream(buffer, options);
+
+    std::vector<lastjson::value> values(stream.begin(), stream.end());
+    BOOST_REQUIRE_EQUAL(values.size(), 4u);
+    BOOST_CHECK_EQUAL(lastjson::stringify(values[0]), "[1.50,\"abc\"]");
+    BOOST_CHECK_EQUAL(lastjson::stringify(values[1]), "2.0");
+    BOOST_CHECK_EQUAL(lastjson::stringify(values[2]), "\"x\"");
+    BOOST_CHECK_EQUAL(lastjson::stringify(values[3]), "7");
+
+    char const * a;
+    char const * b;
+    values[0][1].get_string_range(a, b);
+    BOOST_CHECK(a == buffer->data() + 8);
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, DocumentStream_TestSuite)
+{
+    BOOST_CHECK_THROW(docs("{\"a\":1} {\"a\":"), lastjson::parser_error);
+    BOOST_CHECK_THROW(docs("[1]]"), lastjson::parser_error);
+    BOOST_CHECK_THROW(docs("[1] x"), lastjson::parser_error);
+
+    std::string const json = "[1] [2,] [3]";
+    lastjson::document_stream stream(json);
+    lastjson::value v;
+    BOOST_CHECK(stream.next(v));
+    BOOST_CHECK_THROW(stream.next(v), lastjson::parser_error);
+    BOOST_CHECK(stream.position() == json.data() + 4);
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "[1]");
+
+    lastjson::parse_options options;
+    options.validate_utf8 = true;
+    BOOST_CHECK_THROW(lastjson::document_stream(std::string("\"\xff\""), options), lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,61 @@
+#include <boost/test/unit_test.hpp>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/interned_key.hpp>
+
+BOOST_AUTO_TEST_SUITE( interned_key_test )
+
+namespace {
+class InternedKey_TestSuite
+{
+public:
+  static std::string const & first_key(lastjson::interned_value const & v)
+  {
+      return v.get_object().begin()->first;
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(parse_, InternedKey_TestSuite)
+{
+    std::string const json = "[{\"artist\": \"a\", \"track\": {\"artist\": \"b\"}}, {\"artist\": \"c\", \"zz\": 1}]";
+    lastjson::interned_value v = lastjson::parse<lastjson::interned_value>(json);
+
+    // equal keys share one string
+    BOOST_CHECK(&first_key(v[0]) == &first_key(v[1]));
+    BOOST_CHECK(&first_key(v[0]) == &first_key(v[0]["track"]));
+    BOOST_CHECK_EQUAL(v[1]["artist"].get_string(), "c");
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), lastjson::stringify(lastjson::parse(json)));
+
+    lastjson::interned_value copy;
+    copy.deepcopy(v);
+    BOOST_CHECK(&first_key(copy[0]) == &first_key(v[0]));
+}
+
+BOOST_FIXTURE_TEST_CASE(keys_, InternedKey_TestSuite)
+{
+    lastjson::interned_key const a("artist");
+    lastjson::interned_key const b(std::string("artist"));
+    BOOST_CHECK(&a.str() == &b.str());
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(!(a < b));
+    BOOST_CHECK(lastjson::interned_key("album") < a);
+    BOOST_CHECK(lastjson::interned_key() < a);
+    BOOST_CHECK(lastjson::interned_key() == lastjson::interned_key(""));
+    BOOST_CHECK_EQUAL(a.size(), 6u);
+    BOOST_CHECK_EQUAL(a, "artist");
+
+    // keys from a full table are still equal to interned ones
+    lastjson::key_table table(1);
+    lastjson::shared_ptr<std::string const> x = table.intern("x", "x" + 1);
+    lastjson::shared_ptr<std::string const> y = table.intern("y", "y" + 1);
+    BOOST_CHECK(table.intern("x", "x" + 1) == x);
+    BOOST_CHECK(table.intern("y", "y" + 1) != y);
+    BOOST_CHECK_EQUAL(*table.intern("y", "y" + 1), "y");
+    BOOST_CHECK_EQUAL(table.size(), 1u);
+    table.clear();
+    BOOST_CHECK(table.intern("x", "x" + 1) != x);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -80,6 +80,168 @@ BOOST_FIXTURE_TEST_CASE(parse_primitives, JSON_TestSuite)
   BOOST_CHECK(val.get_bool() == true);
 }
 
+BOOST_FIXTURE_TEST_CASE(parse_ranges, JSON_TestSuite)
+{
+  char const buffer[] = "[\"a\\nb\", {\"k\\u0041\": 1}] trailing garbage";
+  std::string const original(buffer);
+
+  lastjson::value val = lastjson::parse(buffer, 24);
+  BOOST_CHECK(val.is_array());
+  BOOST_CHECK(val[0].get_string() == "a\nb");
+  BOOST_CHECK(val[1]["kA"].get_int() == 1);
+  BOOST_CHECK(std::string(buffer) == original);
+
+  val = lastjson::parse(buffer + 1, buffer + 7);
+  BOOST_CHECK(val.get_string() == "a\nb");
+
+  val = lastjson::parse(original.begin() + 8, original.begin() + 23);
+  BOOST_CHECK(val.is_object());
+  BOOST_CHECK(val["kA"].get_int() == 1);
+  BOOST_CHECK(original == buffer);
+
+  val = lastjson::parse(" \"x\" ");
+  BOOST_CHECK(val.get_string() == "x");
+
+  BOOST_CHECK_THROW(lastjson::parse(buffer, std::size_t(0)), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse(original.begin(), original.begin()), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse(buffer, buffer + 6), lastjson::parser_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(parse_numbers, JSON_TestSuite)
+{
+  lastjson::value val;
+
+  val = lastjson::parse("-0");
+  BOOST_CHECK(val.is_int());
+  BOOST_CHECK(val.get_int() == 0);
+
+  val = lastjson::parse("9223372036854775807");
+  BOOST_CHECK(val.is_int());
+  BOOST_CHECK(val.get_int() == std::numeric_limits<lastjson::int64_t>::max());
+
+  val = lastjson::parse("-9223372036854775808");
+  BOOST_CHECK(val.is_int());
+  BOOST_CHECK(val.get_int() == std::numeric_limits<lastjson::int64_t>::min());
+
+  // integers too large for int_type become floats
+  val = lastjson::parse("9223372036854775808");
+  BOOST_CHECK(val.is_float());
+  BOOST_CHECK(val.get_float() == 9223372036854775808.);
+
+  val = lastjson::parse("-123456789012345678901234567890");
+  BOOST_CHECK(val.is_float());
+  BOOST_CHECK(val.get_float() == -123456789012345678901234567890.);
+
+  val = lastjson::parse("0.1");
+  BOOST_CHECK(val.get_float() == 0.1);
+
+  val = lastjson::parse("-2.5E-3");
+  BOOST_CHECK(val.get_float() == -2.5e-3);
+
+  val = lastjson::parse("1e5");
+  BOOST_CHECK(val.is_float());
+  BOOST_CHECK(val.get_float() == 1e5);
+
+  val = lastjson::parse("1.7976931348623157e308");
+  BOOST_CHECK(val.get_float() == 1.7976931348623157e308);
+
+  val = lastjson::parse("4.9406564584124654e-324");
+  BOOST_CHECK(val.get_float() == 4.9406564584124654e-324);
+
+  val = lastjson::parse("1e-400");
+  BOOST_CHECK(val.get_float() == 0.);
+
+  // halfway between two doubles, decided by the 20th digit
+  val = lastjson::parse("9007199254740993.00000000000000001");
+  BOOST_CHECK(val.get_float() == 9007199254740994.);
+  val = lastjson::parse("1.00000000000000011102230246251565404236316680908203125");
+  BOOST_CHECK(val.get_float() == 1.);
+  val = lastjson::parse("1.00000000000000011102230246251565404236316680908203126");
+  BOOST_CHECK(val.get_float() == 1.0000000000000002);
+
+  val = lastjson::parse("0.30000000000000004");
+  BOOST_CHECK(val.get_float() == 0.30000000000000004);
+
+  BOOST_CHECK_THROW(lastjson::parse("1e400"), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("-"), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("."), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("1e"), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("1e+"), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("1ex"), lastjson::parser_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(parse_nesting, JSON_TestSuite)
+{
+  // both parser engines, with the default depth limit
+  std::string const deep = std::string(1000, '[') + std::string(1000, ']');
+  BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse(deep)), deep);
+  char const * it = deep.data();
+  lastjson::value val = lastjson::impl::parse_fragment<lastjson::value>(it, it + deep.size());
+  BOOST_CHECK_EQUAL(lastjson::stringify(val), deep);
+
+  std::string const hostile(100000, '[');
+  BOOST_CHECK_THROW(lastjson::parse(hostile), lastjson::parser_error);
+  it = hostile.data();
+  BOOST_CHECK_THROW(lastjson::impl::parse_fragment<lastjson::value>(it, it + hostile.size()),
+                    lastjson::parser_error);
+
+  std::string const too_deep = std::string(1025, '[') + std::string(1025, ']');
+  BOOST_CHECK_THROW(lastjson::parse(too_deep), lastjson::parser_error);
+
+  lastjson::parse_options options;
+  options.max_depth = 3;
+  BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse("[{\"a\":[]}]", options)), "[{\"a\":[]}]");
+  BOOST_CHECK_THROW(lastjson::parse("[{\"a\":[[]]}]", options), lastjson::parser_error);
+  BOOST_CHECK_THROW(lastjson::parse("[[[{}]]]", options), lastjson::parser_error);
+
+  options.max_depth = 100000;
+  BOOST_CHECK_THROW(lastjson::parse(hostile, options), lastjson::parser_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(parse_shared_strings, JSON_TestSuite)
+{
+  lastjson::shared_ptr<std::string const> buffer(
+      new std::string("[\"abc\", \"a\\nb\", {\"key\": \"a string longer than the short string buffer\"}, \"\"]"));
+  lastjson::value val = lastjson::parse_shared(buffer);
+  BOOST_CHECK(buffer.use_count() > 1);
+
+  char const * a;
+  char const * b;
+  val[0].get_string_range(a, b);
+  BOOST_CHECK(a == buffer->data() + 2);
+  BOOST_CHECK(b == a + 3);
+  BOOST_CHECK(val[0].get_bool());
+  BOOST_CHECK(!val[3].get_bool());
+
+  lastjson::value copy = val[2]["key"];
+  lastjson::value const & const_copy = copy;
+  BOOST_CHECK_EQUAL(const_copy.get_string(), "a string longer than the short string buffer");
+  BOOST_CHECK_EQUAL(val[1].get_string(), "a\nb");
+  BOOST_CHECK_EQUAL(lastjson::stringify(val),
+                    "[\"abc\",\"a\\nb\",{\"key\":\"a string longer than the short string buffer\"},\"\"]");
+
+  val[0].get_string_ref() += "def";
+  BOOST_CHECK_EQUAL(lastjson::stringify(val[0]), "\"abcdef\"");
+  BOOST_CHECK_EQUAL(*buffer, "[\"abc\", \"a\\nb\", {\"key\": \"a string longer than the short string buffer\"}, \"\"]");
+
+  // strings copied out of the buffer no longer keep it alive
+  lastjson::value kept = val[3];
+  val = lastjson::value();
+  BOOST_CHECK_EQUAL(buffer.use_count(), 2);
+  kept = lastjson::value();
+  BOOST_CHECK_EQUAL(buffer.use_count(), 1);
+
+  // parse_destructive takes over the string instead of copying strings out of it
+  lastjson::value taken;
+  {
+    std::string json = "{\"a\": [\"x\", \"\\u00e9\"], \"b\": \"yz\"}";
+    taken = lastjson::parse_destructive(json);
+  }
+  BOOST_CHECK_EQUAL(taken["a"][0].get_string(), "x");
+  BOOST_CHECK_EQUAL(taken["a"][1].get_string(), "\xc3\xa9");
+  BOOST_CHECK_EQUAL(lastjson::stringify(taken["b"]), "\"yz\"");
+}
+
 BOOST_FIXTURE_TEST_CASE(stringify_primitives, JSON_TestSuite)
 {
   lastjson::value val;
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/lazy_parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( lazy_parse_test )
+
+namespace {
+class LazyParse_TestSuite
+{
+public:
+  LazyParse_TestSuite()
+      : envelope("{\"id\": 7, \"payload\": {\"a\" : [1, 2, {\"b\": \"]}\\\"\"}], \"c\": null} , "
+                 "\"tags\": [ \"x\" ], \"empty\": {}}")
+  {
+  }
+
+  static lastjson::lazy_options depth(std::size_t d)
+  {
+      lastjson::lazy_options options;
+      options.depth = d;
+      return options;
+  }
+
+  std::string const envelope;
+};
+
+BOOST_FIXTURE_TEST_CASE(deferred_, LazyParse_TestSuite)
+{
+    lastjson::value v;
+    {
+        // the value must not depend on the lifetime of the input string
+        std::string const copy = envelope;
+        v = lastjson::parse_lazy(copy);
+    }
+
+    BOOST_CHECK(!v.is_lazy());
+    BOOST_CHECK_EQUAL(v["id"].get_int(), 7);
+    BOOST_CHECK(v["payload"].is_lazy());
+    BOOST_CHECK(v["payload"].is_object());
+    BOOST_CHECK(v["tags"].is_lazy());
+    BOOST_CHECK(v["tags"].is_array());
+
+    // untouched subtrees are written out verbatim
+    BOOST_CHECK_EQUAL(lastjson::stringify(v),
+                      "{\"empty\":{},\"id\":7,\"payload\":{\"a\" : [1, 2, {\"b\": \"]}\\\"\"}], \"c\": null},"
+                      "\"tags\":[ \"x\" ]}");
+
+    lastjson::value const payload = v["payload"];
+    BOOST_CHECK_EQUAL(payload["a"][2]["b"].get_string(), "]}\"");
+    BOOST_CHECK(!payload.is_lazy());
+    BOOST_CHECK(!v["payload"].is_lazy());
+    BOOST_CHECK(v["tags"].is_lazy());
+
+    v["payload"]["c"] = 1;
+    BOOST_CHECK_EQUAL(lastjson::stringify(v["payload"]), "{\"a\":[1,2,{\"b\":\"]}\\\"\"}],\"c\":1}");
+    BOOST_CHECK_EQUAL(lastjson::stringify(payload), "{\"a\":[1,2,{\"b\":\"]}\\\"\"}],\"c\":1}");
+}
+
+BOOST_FIXTURE_TEST_CASE(depth_, LazyParse_TestSuite)
+{
+    lastjson::value root = lastjson::parse_lazy(" " + envelope + " ", depth(0));
+    BOOST_CHECK(root.is_lazy());
+    BOOST_CHECK_EQUAL(lastjson::stringify(root), envelope);
+    BOOST_CHECK_EQUAL(lastjson::stringify(root),
+                      lastjson::stringify(lastjson::parse_lazy(envelope, depth(0))));
+
+    lastjson::value deep = lastjson::parse_lazy(envelope, depth(2));
+    BOOST_CHECK(!deep["payload"].is_lazy());
+    BOOST_CHECK(deep["payload"]["a"].is_lazy());
+    BOOST_CHECK(!deep["empty"].is_lazy());
+    BOOST_CHECK_EQUAL(lastjson::stringify(deep["payload"]["a"]), "[1, 2, {\"b\": \"]}\\\"\"}]");
+
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_lazy(envelope, depth(10))),
+                      lastjson::stringify(lastjson::parse(envelope)));
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_lazy("\"x\"", depth(0))), "\"x\"");
+
+    lastjson::value copy;
+    copy.deepcopy(lastjson::parse_lazy(envelope));
+    BOOST_CHECK(!copy["payload"].is_lazy());
+    BOOST_CHECK_EQUAL(copy["payload"]["a"][1].get_int(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, LazyParse_TestSuite)
+{
+    // errors within deferred subtrees surface on first access
+    lastjson::value v = lastjson::parse_lazy("[1, {\"a\": [1,, 2]}]");
+    BOOST_CHECK_THROW(v[1].get_object(), lastjson::parser_error);
+    BOOST_CHECK(v[1].is_lazy());
+    BOOST_CHECK_THROW(v[1].get_object(), lastjson::parser_error);
+
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[1, {\"a\": [1, 2]]"), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[1, {\"a\": \"]}"), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[1, {}] x"), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_lazy("{\"a\" 1}"), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[1 2]"), lastjson::parser_error);
+
+    lastjson::lazy_options shallow;
+    shallow.parse.max_depth = 3;
+    BOOST_CHECK_NO_THROW(lastjson::parse_lazy("[[[1]]]", shallow));
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[[[[1]]]]", shallow), lastjson::parser_error);
+    shallow.depth = 0;
+    BOOST_CHECK_THROW(lastjson::parse_lazy("[[[[1]]]]", shallow), lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
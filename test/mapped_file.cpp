@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/mapped_file.hpp>
+
+BOOST_AUTO_TEST_SUITE( mapped_file_test )
+
+namespace {
+class MappedFile_TestSuite
+{
+public:
+  MappedFile_TestSuite()
+  {
+      char name[] = "/tmp/lastjson-test-XXXXXX";
+      int fd = ::mkstemp(name);
+      BOOST_REQUIRE(fd >= 0);
+      ::close(fd);
+      path = name;
+  }
+
+  ~MappedFile_TestSuite()
+  {
+      std::remove(path.c_str());
+  }
+
+  void write(std::string const & contents)
+  {
+      FILE * f = std::fopen(path.c_str(), "wb");
+      BOOST_REQUIRE(f);
+      std::fwrite(contents.data(), 1, contents.size(), f);
+      std::fclose(f);
+  }
+
+  std::string path;
+};
+
+BOOST_FIXTURE_TEST_CASE(parse_, MappedFile_TestSuite)
+{
+    write("{\"a\": [1, 2.5, \"x\\ny\"], \"b\": null}\n");
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_file(path)),
+                      "{\"a\":[1,2.5,\"x\\ny\"],\"b\":null}");
+
+    lastjson::mapped_file file(path);
+    BOOST_CHECK_EQUAL(file.size(), 35u);
+    BOOST_CHECK_EQUAL(std::string(file.begin(), file.end()).substr(0, 6), "{\"a\": ");
+}
+
+BOOST_FIXTURE_TEST_CASE(lazy_, MappedFile_TestSuite)
+{
+    write("{\"a\": 1, \"b\": [2, {\"c\": 3}]}");
+    lastjson::value v = lastjson::parse_file_lazy(path);
+    BOOST_CHECK(v["b"].is_lazy());
+
+    // the mapping outlives the file
+    std::remove(path.c_str());
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "{\"a\":1,\"b\":[2, {\"c\": 3}]}");
+    BOOST_CHECK_EQUAL(v["b"][1]["c"].get_int(), 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, MappedFile_TestSuite)
+{
+    BOOST_CHECK_THROW(lastjson::parse_file(path), lastjson::parser_error);
+    write("[1, 2");
+    BOOST_CHECK_THROW(lastjson::parse_file(path), lastjson::parser_error);
+
+    lastjson::parse_options options;
+    options.max_depth = 2;
+    write("[[[]]]");
+    BOOST_CHECK_THROW(lastjson::parse_file(path, options), lastjson::parser_error);
+
+    BOOST_CHECK_THROW(lastjson::parse_file(path + "-missing"), lastjson::file_error);
+    BOOST_CHECK_THROW(lastjson::mapped_file("/"), lastjson::file_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/ndjson.hpp>
+
+BOOST_AUTO_TEST_SUITE( ndjson_test )
+
+namespace {
+class NDJSON_TestSuite
+{
+public:
+  static std::string make_lines(int n)
+  {
+      std::ostringstream out;
+      for (int i = 0; i < n; ++i)
+      {
+          out << "{\"n\": " << i << ", \"s\": \"" << std::string(i % 50, 'x') << "\"}\n";
+      }
+      return out.str();
+  }
+
+  static lastjson::ndjson_options small_batches()
+  {
+      lastjson::ndjson_options options;
+      options.threads = 4;
+      options.batch_size = 100;
+      return options;
+  }
+
+  struct summing_callback
+  {
+      summing_callback() : records(0), sum(0) {}
+
+      std::size_t records;
+      int64_t sum;
+
+      void operator()(lastjson::ndjson_record & record)
+      {
+          BOOST_CHECK_EQUAL(record.line, records + 1);
+          ++records;
+          sum += record.value["n"].get_int();
+      }
+  };
+
+  struct throwing_callback
+  {
+      void operator()(lastjson::ndjson_record & record)
+      {
+          if (record.line == 500)
+          {
+              throw std::runtime_error("stop");
+          }
+      }
+  };
+};
+
+BOOST_FIXTURE_TEST_CASE(order_, NDJSON_TestSuite)
+{
+    std::string const txt = make_lines(2000);
+    lastjson::ndjson_parser parser(small_batches());
+    BOOST_CHECK_EQUAL(parser.threads(), 4u);
+
+    std::vector<lastjson::ndjson_record> const records = parser.parse(txt);
+    BOOST_REQUIRE_EQUAL(records.size(), 2000u);
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        BOOST_CHECK(records[i].ok());
+        BOOST_CHECK_EQUAL(records[i].line, i + 1);
+        BOOST_CHECK_EQUAL(records[i].value["n"].get_int(), int64_t(i));
+    }
+
+    summing_callback sum;
+    parser.parse(txt.data(), txt.data() + txt.size(), sum);
+    BOOST_CHECK_EQUAL(sum.records, 2000u);
+    BOOST_CHECK_EQUAL(sum.sum, 1999 * 2000 / 2);
+
+    BOOST_CHECK(parser.parse("").empty());
+    BOOST_CHECK_EQUAL(lastjson::parse_ndjson("1\n2").size(), 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, NDJSON_TestSuite)
+{
+    std::string const txt = "[1]\r\n\n  \n{\"a\":\n\"ok\"\ntrue false\n[2]";
+    std::vector<lastjson::ndjson_record> const records =
+        lastjson::parse_ndjson(txt, small_batches());
+    BOOST_REQUIRE_EQUAL(records.size(), 5u);
+
+    BOOST_CHECK(records[0].ok());
+    BOOST_CHECK_EQUAL(records[0].line, 1u);
+    BOOST_CHECK_EQUAL(lastjson::stringify(records[0].value), "[1]");
+    BOOST_CHECK(!records[1].ok());
+    BOOST_CHECK_EQUAL(records[1].line, 4u);
+    BOOST_CHECK(records[1].value.is_null());
+    BOOST_CHECK(records[2].ok());
+    BOOST_CHECK_EQUAL(records[2].line, 5u);
+    BOOST_CHECK(!records[3].ok());
+    BOOST_CHECK_EQUAL(records[3].line, 6u);
+    BOOST_CHECK(records[4].ok());
+    BOOST_CHECK_EQUAL(records[4].line, 7u);
+
+    // an exception from the callback ends the batch, the parser stays usable
+    std::string const lines = make_lines(2000);
+    lastjson::ndjson_parser parser(small_batches());
+    throwing_callback thrower;
+    BOOST_CHECK_THROW(parser.parse(lines.data(), lines.data() + lines.size(), thrower),
+                      std::runtime_error);
+    BOOST_CHECK_EQUAL(parser.parse(lines).size(), 2000u);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/parallel_parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( parallel_parse_test )
+
+namespace {
+class ParallelParse_TestSuite
+{
+public:
+  static std::string make_array(int n)
+  {
+      std::ostringstream out;
+      out << " [\n";
+      for (int i = 0; i < n; ++i)
+      {
+          out << (i ? ",\n " : "") << "{\"id\": " << i
+              << ", \"s\": \"a ], [ } \\\" , " << std::string(i % 70, '\\') << std::string(i % 70, '\\')
+              << "\", \"a\": [[], {}, [" << i << ", \"x\"]]}";
+      }
+      out << "\n] ";
+      return out.str();
+  }
+
+  static lastjson::parallel_options small_chunks()
+  {
+      lastjson::parallel_options options;
+      options.threads = 4;
+      options.chunk_size = 200;
+      return options;
+  }
+
+  static void failtest(std::string const & txt)
+  {
+      BOOST_CHECK_THROW(lastjson::parse_parallel(txt, small_chunks()), lastjson::parser_error);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(split_, ParallelParse_TestSuite)
+{
+    std::string const txt = make_array(1000);
+    char const * const begin = txt.data() + 1;
+    std::vector<lastjson::impl::array_chunk> chunks;
+    std::size_t close = 0;
+    BOOST_REQUIRE(lastjson::impl::split_array(begin, txt.size() - 1, 1000, chunks, close));
+    BOOST_CHECK_EQUAL(begin[close], ']');
+    BOOST_CHECK(chunks.size() > 10);
+
+    std::size_t elements = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(chunks[i].first_element, elements);
+        elements += chunks[i].elements;
+    }
+    BOOST_CHECK_EQUAL(elements, 1000u);
+
+    chunks.clear();
+    BOOST_REQUIRE(lastjson::impl::split_array("[ ]", 3, 1, chunks, close));
+    BOOST_CHECK_EQUAL(chunks.size(), 1u);
+    BOOST_CHECK_EQUAL(chunks[0].elements, 0u);
+    BOOST_CHECK(!lastjson::impl::split_array("[1, [2]", 7, 1, chunks, close));
+}
+
+BOOST_FIXTURE_TEST_CASE(parse_, ParallelParse_TestSuite)
+{
+    std::string const txt = make_array(1000);
+    std::string const expected = lastjson::stringify(lastjson::parse(txt));
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_parallel(txt, small_chunks())), expected);
+
+    lastjson::parallel_options one_thread = small_chunks();
+    one_thread.threads = 1;
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_parallel(txt, one_thread)), expected);
+
+    // documents that are not worth splitting
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_parallel(txt)), expected);
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_parallel("[]", small_chunks())), "[]");
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_parallel("{\"a\":[1]}", small_chunks())),
+                      "{\"a\":[1]}");
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, ParallelParse_TestSuite)
+{
+    std::string const txt = make_array(1000);
+    std::size_t const split = txt.find(",\n ", txt.size() / 2);
+    std::string const middle = txt.substr(0, split);
+    std::string const rest = txt.substr(split);
+
+    failtest(txt + "x");
+    failtest(txt.substr(0, txt.size() - 3));
+    failtest(middle + ",," + rest);
+    failtest(txt.substr(0, txt.size() - 3) + ",]");
+    failtest(middle + " tru " + rest);
+    failtest(middle + "]" + rest);
+
+    lastjson::parallel_options shallow = small_chunks();
+    shallow.parse.max_depth = 3;
+    BOOST_CHECK_THROW(lastjson::parse_parallel(txt, shallow), lastjson::parser_error);
+    shallow.parse.max_depth = 4;
+    BOOST_CHECK_NO_THROW(lastjson::parse_parallel(txt, shallow));
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,100 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/interned_key.hpp>
+
+BOOST_AUTO_TEST_SUITE( parse_into_test )
+
+namespace {
+class ParseInto_TestSuite
+{
+public:
+  // parse_into must give what parse gives, whatever the target held before
+  template<class Value>
+  static void check(Value & target, std::string const & json)
+  {
+      lastjson::parse_into(json, target);
+      BOOST_CHECK_EQUAL(lastjson::stringify(target), lastjson::stringify(lastjson::parse<Value>(json)));
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(results_, ParseInto_TestSuite)
+{
+    char const * const docs[] =
+    {
+        "{\"a\": [1, 2, 3], \"b\": {\"c\": \"x\", \"d\": null}, \"e\": \"long enough to be on the heap\"}",
+        "{\"a\": [1, 2, 3], \"b\": {\"c\": \"y\", \"d\": true}, \"e\": \"short\"}",
+        "{\"a\": [4], \"b\": {\"d\": 1.5}}",
+        "{\"a\": [4, [5, 6], {\"f\": 7}, \"g\", 8], \"e\": {\"a\": []}, \"h\": {}}",
+        "{\"a\": \"no longer an array\", \"b\": [{\"c\": 1}, {\"c\": 2}], \"a\": [9]}",
+        "[1, \"two\", [3], {\"four\": 4}]",
+        "[[], {}, null]",
+        "\"just a string\"",
+        "42",
+        "{\"a\": [1, 2, 3], \"b\": {\"c\": \"x\", \"d\": null}, \"e\": \"long enough to be on the heap\"}",
+    };
+
+    lastjson::value v;
+    for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+    {
+        check(v, docs[i]);
+    }
+
+    lastjson::interned_value iv;
+    for (std::size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); ++i)
+    {
+        check(iv, docs[i]);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(reuse_, ParseInto_TestSuite)
+{
+    lastjson::value v;
+    lastjson::parse_into("{\"list\": [1, 2, 3], \"name\": \"a string longer than any small buffer\", \"old\": 1}", v);
+
+    lastjson::value::array_type const * const list = &v["list"].get_array();
+    lastjson::value::object_type const * const object = &v.get_object();
+    char const * const name = v["name"].get_string().data();
+    lastjson::value const * const member = &v["list"];
+
+    lastjson::parse_into("{\"list\": [4, 5], \"name\": \"another string, but not longer\"}", v);
+    BOOST_CHECK(&v.get_object() == object);
+    BOOST_CHECK(&v["list"] == member);
+    BOOST_CHECK(&v["list"].get_array() == list);
+    BOOST_CHECK(v["name"].get_string().data() == name);
+    BOOST_CHECK(v.get_object().find("old") == v.get_object().end());
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "{\"list\":[4,5],\"name\":\"another string, but not longer\"}");
+}
+
+BOOST_FIXTURE_TEST_CASE(shared_, ParseInto_TestSuite)
+{
+    lastjson::value v = lastjson::parse("{\"list\": [1, 2], \"name\": \"x\"}");
+    lastjson::value const copy = v;
+    lastjson::value const list = v["list"];
+    BOOST_CHECK(!v.is_unique());
+
+    lastjson::parse_into("{\"list\": [3], \"name\": \"y\"}", v);
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "{\"list\":[3],\"name\":\"y\"}");
+    BOOST_CHECK_EQUAL(lastjson::stringify(copy), "{\"list\":[1,2],\"name\":\"x\"}");
+    BOOST_CHECK_EQUAL(lastjson::stringify(list), "[1,2]");
+
+    lastjson::value other = v;
+    lastjson::parse_into("[]", v);
+    BOOST_CHECK_EQUAL(lastjson::stringify(other), "{\"list\":[3],\"name\":\"y\"}");
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, ParseInto_TestSuite)
+{
+    lastjson::value v;
+    BOOST_CHECK_THROW(lastjson::parse_into("{\"a\": [1, 2", v), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_into("[1] 2", v), lastjson::parser_error);
+
+    // the target is usable afterwards
+    check(v, "{\"a\": [1, 2]}");
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
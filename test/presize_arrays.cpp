@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( presize_arrays_test )
+
+namespace {
+class PresizeArrays_TestSuite
+{
+public:
+  PresizeArrays_TestSuite()
+  {
+      options.presize_arrays = true;
+  }
+
+  lastjson::parse_options options;
+
+  static std::vector<uint32_t> count(std::string const & json)
+  {
+      std::vector<uint32_t> index;
+      std::vector<uint32_t> sizes;
+      lastjson::impl::build_structural_index(json.data(), json.size(), index, lastjson::impl::SIMD_NONE);
+      lastjson::impl::count_array_elements(json.data(), index, sizes);
+      return sizes;
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(count_, PresizeArrays_TestSuite)
+{
+  std::vector<uint32_t> sizes = count("[1, [], [[2], {\"a\": [3, 4], \"b\": 5}], \"[,]\", [\"x,\", \"]\"]]");
+  BOOST_REQUIRE_EQUAL(sizes.size(), 6u);
+  BOOST_CHECK_EQUAL(sizes[0], 5u);
+  BOOST_CHECK_EQUAL(sizes[1], 0u);
+  BOOST_CHECK_EQUAL(sizes[2], 2u);
+  BOOST_CHECK_EQUAL(sizes[3], 1u);
+  BOOST_CHECK_EQUAL(sizes[4], 2u);
+  BOOST_CHECK_EQUAL(sizes[5], 2u);
+
+  BOOST_CHECK(count("{\"a\": 1, \"b\": \"[\"}").empty());
+  BOOST_CHECK_EQUAL(count("[ ]")[0], 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(reserved_, PresizeArrays_TestSuite)
+{
+  // big enough for the structural index engine
+  std::string json = "{\"tracks\": [";
+  for (int i = 0; i < 1000; ++i)
+  {
+      json += i ? ",{\"tags\": [1, 2, 3]}" : "{\"tags\": [\"a\", [], {}]}";
+  }
+  json += "], \"empty\": []}";
+
+  lastjson::value const v = lastjson::parse(json, options);
+  BOOST_CHECK_EQUAL(lastjson::stringify(v), lastjson::stringify(lastjson::parse(json)));
+  BOOST_CHECK_EQUAL(v["tracks"].get_array().size(), 1000u);
+  BOOST_CHECK_EQUAL(v["tracks"].get_array().capacity(), 1000u);
+  BOOST_CHECK_EQUAL(v["tracks"][999]["tags"].get_array().capacity(), 3u);
+  BOOST_CHECK_EQUAL(v["empty"].get_array().capacity(), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(invalid_, PresizeArrays_TestSuite)
+{
+  std::string json = "[";
+  for (int i = 0; i < 100; ++i)
+  {
+      json += "[1, 2], ";
+  }
+
+  lastjson::value result;
+  BOOST_CHECK(!lastjson::try_parse(json + "]", result, options).ok());
+  BOOST_CHECK(!lastjson::try_parse(json + "[3}]", result, options).ok());
+  BOOST_CHECK(!lastjson::try_parse(json, result, options).ok());
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
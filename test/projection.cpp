@@ -0,0 +1,81 @@
+#include <boost/test/unit_test.hpp>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/projection.hpp>
+
+BOOST_AUTO_TEST_SUITE( projection_test )
+
+namespace {
+class Projection_TestSuite
+{
+public:
+  Projection_TestSuite()
+      : doc("{\"user\": {\"id\": 42, \"name\": \"x\", \"tags\": [1, {\"a\": \"]\"}]},"
+            " \"items\": [{\"price\": 1.5, \"sku\": \"a\"}, {\"sku\": \"b\"}, {\"price\": 3, \"x\": [[]]}],"
+            " \"a/b\": 1, \"m~n\": 2, \"*\": 3, \"\": 4}")
+  {
+  }
+
+  std::string project(char const * a, char const * b = 0, char const * c = 0)
+  {
+      std::vector<std::string> pointers(1, a);
+      if (b)
+      {
+          pointers.push_back(b);
+      }
+      if (c)
+      {
+          pointers.push_back(c);
+      }
+
+      return lastjson::stringify(lastjson::parse_projected(doc, pointers));
+  }
+
+  std::string const doc;
+};
+
+BOOST_FIXTURE_TEST_CASE(paths_, Projection_TestSuite)
+{
+    BOOST_CHECK_EQUAL(project("/user/id", "/items/*/price"),
+                      "{\"items\":[{\"price\":1.5},null,{\"price\":3}],\"user\":{\"id\":42}}");
+    BOOST_CHECK_EQUAL(project(""), lastjson::stringify(lastjson::parse(doc)));
+    BOOST_CHECK_EQUAL(project("/user"), "{\"user\":{\"id\":42,\"name\":\"x\",\"tags\":[1,{\"a\":\"]\"}]}}");
+    BOOST_CHECK_EQUAL(project("/items/1/sku"), "{\"items\":[null,{\"sku\":\"b\"}]}");
+    BOOST_CHECK_EQUAL(project("/items/1"), "{\"items\":[null,{\"sku\":\"b\"}]}");
+    BOOST_CHECK_EQUAL(project("/items/*/sku", "/items/2"),
+                      "{\"items\":[{\"sku\":\"a\"},{\"sku\":\"b\"},{\"price\":3,\"x\":[[]]}]}");
+    BOOST_CHECK_EQUAL(project("/*/id"), "{\"user\":{\"id\":42}}");
+    BOOST_CHECK_EQUAL(project("/a~1b", "/m~0n", "/"), "{\"\":4,\"a/b\":1,\"m~n\":2}");
+    BOOST_CHECK_EQUAL(project("/missing", "/user/id/deeper", "/items/x"), "null");
+
+    lastjson::projection const compiled(std::vector<std::string>(1, "/id"));
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_projected("{\"x\": [1], \"id\": 7}", compiled)),
+                          "{\"id\":7}");
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, Projection_TestSuite)
+{
+    BOOST_CHECK_THROW(project("user"), lastjson::parser_error);
+    BOOST_CHECK_THROW(project("/a~2"), lastjson::parser_error);
+
+    std::vector<std::string> const id(1, "/id");
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"x\": [1, \"2], \"id\": 7}", id), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"x\": [1, 2], \"id\": 7", id), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"x\": [1, 2] \"id\": 7}", id), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"id\": 7} 1", id), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"id\": tru}", id), lastjson::parser_error);
+
+    lastjson::parse_options options;
+    options.max_depth = 2;
+    BOOST_CHECK_NO_THROW(lastjson::parse_projected("{\"x\": [1], \"id\": [7]}", lastjson::projection(id), options));
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"x\": [[1]], \"id\": 7}", lastjson::projection(id), options),
+                      lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse_projected("{\"x\": 1, \"id\": [[7]]}", lastjson::projection(id), options),
+                      lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
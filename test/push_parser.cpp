@@ -0,0 +1,108 @@
+#include <boost/test/unit_test.hpp>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/push_parser.hpp>
+
+BOOST_AUTO_TEST_SUITE( push_parser_test )
+
+namespace {
+class PushParser_TestSuite
+{
+public:
+  // feed txt in two pieces, split at every possible position
+  static void splittest(std::string const & txt)
+  {
+      std::string const expected = lastjson::stringify(lastjson::parse(txt));
+      lastjson::push_parser parser;
+
+      for (size_t split = 0; split <= txt.size(); ++split)
+      {
+          parser.feed(txt.data(), split);
+          parser.feed(txt.data() + split, txt.size() - split);
+          BOOST_CHECK_EQUAL(lastjson::stringify(parser.finish()), expected);
+      }
+
+      for (size_t i = 0; i < txt.size(); ++i)
+      {
+          parser.feed(txt.data() + i, 1);
+      }
+      BOOST_CHECK_EQUAL(lastjson::stringify(parser.finish()), expected);
+  }
+
+  static void failtest(std::string const & txt)
+  {
+      for (size_t split = 0; split <= txt.size(); ++split)
+      {
+          lastjson::push_parser parser;
+          BOOST_CHECK_THROW(
+              parser.feed(txt.data(), split);
+              parser.feed(txt.data() + split, txt.size() - split);
+              parser.finish(),
+              lastjson::parser_error);
+      }
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(split_, PushParser_TestSuite)
+{
+    splittest("null");
+    splittest(" true ");
+    splittest("false");
+    splittest("-12345");
+    splittest("1.5e-3");
+    splittest("\"\"");
+    splittest("\"foo \\\"bar\\\" \\\\\"");
+    splittest("\"\\ud852\\udf62 \\u20ac \\n\"");
+    splittest("[]");
+    splittest("{}");
+    splittest("[1,2.5,-3e2,true,false,null,\"x\",[],{}]");
+    splittest("{ \"a\" : [ { \"b\\u0041\" : 12 } , \"c\" ] , \"d\" : -0.25 }");
+}
+
+BOOST_FIXTURE_TEST_CASE(reuse_, PushParser_TestSuite)
+{
+    lastjson::push_parser parser;
+    parser.feed("[1, 2");
+    BOOST_CHECK_EQUAL(parser.depth(), 1u);
+    parser.feed("3]");
+    BOOST_CHECK_EQUAL(lastjson::stringify(parser.finish()), "[1,23]");
+
+    parser.feed("{\"k\":");
+    parser.feed("\"v\"}");
+    BOOST_CHECK_EQUAL(lastjson::stringify(parser.finish()), "{\"k\":\"v\"}");
+
+    parser.feed("[1,");
+    BOOST_CHECK_THROW(parser.feed("]"), lastjson::parser_error);
+    BOOST_CHECK_THROW(parser.feed("1]"), lastjson::parser_error);
+    parser.reset();
+    parser.feed("7");
+    BOOST_CHECK_EQUAL(parser.finish().get_int(), 7);
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, PushParser_TestSuite)
+{
+    failtest("");
+    failtest("[");
+    failtest("[1 2]");
+    failtest("{\"a\" 1}");
+    failtest("{\"a\":1,}");
+    failtest("\"abc");
+    failtest("\"\\ud852\"");
+    failtest("nul");
+    failtest("truex");
+    failtest("1-2");
+    failtest("1 2");
+    failtest("[1]]");
+    failtest(std::string(2000, '['));
+
+    lastjson::parse_options options;
+    options.max_depth = 2;
+    lastjson::push_parser parser(options);
+    parser.feed("[[]]");
+    BOOST_CHECK_EQUAL(lastjson::stringify(parser.finish()), "[[]]");
+    BOOST_CHECK_THROW(parser.feed("[[{"), lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
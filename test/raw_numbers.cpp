@@ -0,0 +1,105 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( raw_numbers_test )
+
+namespace {
+class RawNumbers_TestSuite
+{
+public:
+  RawNumbers_TestSuite()
+  {
+      options.raw_numbers = true;
+  }
+
+  lastjson::parse_options options;
+};
+
+BOOST_FIXTURE_TEST_CASE(roundtrip_, RawNumbers_TestSuite)
+{
+  std::string const json = "[0.1,3.141592653589793,-2.5e-7,1E+300,12345678901234567890123,-0,7]";
+  BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse(json, options)), json);
+  BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse("{\"a\": 1.50 , \"b\" :[ 2.000 ]}", options)),
+                    "{\"a\":1.50,\"b\":[2.000]}");
+
+  // without the option, floats are formatted anew
+  BOOST_CHECK(lastjson::stringify(lastjson::parse(json)) != json);
+}
+
+BOOST_FIXTURE_TEST_CASE(values_, RawNumbers_TestSuite)
+{
+  lastjson::value const v = lastjson::parse("{\"i\": -17, \"f\": 2.50, \"s\": \"3\"}", options);
+  BOOST_CHECK(v["i"].is_int());
+  BOOST_CHECK_EQUAL(v["i"].get_int(), -17);
+  BOOST_CHECK(v["f"].is_float());
+  BOOST_CHECK_EQUAL(v["f"].get_float(), 2.5);
+
+  char const * a;
+  char const * b;
+  BOOST_CHECK(v["f"].get_number_text(a, b));
+  BOOST_CHECK_EQUAL(std::string(a, b), "2.50");
+  BOOST_CHECK(!v["s"].get_number_text(a, b));
+  BOOST_CHECK(!lastjson::parse("2.50").get_number_text(a, b));
+
+  // copies keep the text, which outlives the input
+  lastjson::value copy;
+  {
+      lastjson::value const temporary = lastjson::parse(std::string("[1.0e0]"), options);
+      copy = temporary[0];
+  }
+  BOOST_CHECK_EQUAL(lastjson::stringify(copy), "1.0e0");
+}
+
+BOOST_FIXTURE_TEST_CASE(modified_, RawNumbers_TestSuite)
+{
+  lastjson::value v = lastjson::parse("[1.0, 2]", options);
+  v[0].get_float_ref() = 0.5;
+  v[1].get_int_ref() += 1;
+
+  char const * a;
+  char const * b;
+  BOOST_CHECK(!v[0].get_number_text(a, b));
+  BOOST_CHECK_EQUAL(lastjson::stringify(v), "[0.5,3]");
+
+  v[0] = 4;
+  BOOST_CHECK_EQUAL(lastjson::stringify(v), "[4,3]");
+}
+
+BOOST_FIXTURE_TEST_CASE(shared_, RawNumbers_TestSuite)
+{
+  // a number ending the input must not be read on into the buffer
+  lastjson::shared_ptr<std::string const> const buffer(new std::string("1.25e2, 7"));
+  char const * const begin = buffer->data();
+  lastjson::value const v = lastjson::parse_shared(begin, begin + 6, buffer, options);
+  BOOST_CHECK_EQUAL(v.get_float(), 125.0);
+  BOOST_CHECK_EQUAL(lastjson::stringify(v), "1.25e2");
+
+  lastjson::value const w = lastjson::parse_shared(begin, begin + 4, buffer, options);
+  BOOST_CHECK_EQUAL(lastjson::stringify(w), "1.25");
+
+  lastjson::value const d = lastjson::parse_destructive("[0.10, {\"x\": 1e1}]", options);
+  BOOST_CHECK_EQUAL(lastjson::stringify(d), "[0.10,{\"x\":1e1}]");
+}
+
+BOOST_FIXTURE_TEST_CASE(large_, RawNumbers_TestSuite)
+{
+  // big enough for the structural index engine
+  std::string json = "[";
+  for (int i = 0; i < 20000; ++i)
+  {
+      json += i ? ",0.1000" : "0.1000";
+  }
+  json += "]";
+
+  lastjson::value result;
+  BOOST_CHECK(lastjson::try_parse(json, result, options).ok());
+  BOOST_CHECK_EQUAL(lastjson::stringify(result), json);
+  BOOST_CHECK_EQUAL(result[19999].get_float(), 0.1);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
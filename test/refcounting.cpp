@@ -176,5 +176,41 @@ BOOST_FIXTURE_TEST_CASE(refcounting_, Refcounting_TestSuite)
 
 }
 
+BOOST_FIXTURE_TEST_CASE(refcounting_parse_, Refcounting_TestSuite)
+{
+  mystring::instance_counter = 0;
+
+  {
+    rct_value val = lastjson::parse<rct_value>("[\"foo\", \"b\\u00e4r\", {\"baz\": [\"x\", 1, 2.5, true, null]}]");
+    BOOST_CHECK_EQUAL(mystring::instance_counter, 3);
+    BOOST_CHECK(val[0].get_string() == "foo");
+    BOOST_CHECK(val[1].get_string() == "b\xc3\xa4r");
+    BOOST_CHECK(val[2]["baz"][0].get_string() == "x");
+    BOOST_CHECK_EQUAL(val[2]["baz"][1].get_int(), 1);
+    BOOST_CHECK_EQUAL(val[2]["baz"][2].get_float(), 2.5);
+    BOOST_CHECK(val[2]["baz"][3].get_bool());
+    BOOST_CHECK(val[2]["baz"][4].is_null());
+    BOOST_CHECK_EQUAL(lastjson::stringify(val), "[\"foo\",\"b\\u00e4r\",{\"baz\":[\"x\",1,2.5,true,null]}]");
+
+    val[2] = false;
+    BOOST_CHECK_EQUAL(mystring::instance_counter, 2);
+  }
+  BOOST_CHECK_EQUAL(mystring::instance_counter, 0);
+
+  {
+    // large enough to be handled by the structural index engine
+    std::string txt = "[";
+    for (int i = 0; i < 100; ++i)
+    {
+      txt += i ? ", \"element\"" : "\"element\"";
+    }
+    txt += "]";
+    rct_value val = lastjson::parse<rct_value>(txt);
+    BOOST_CHECK_EQUAL(val.get_array().size(), 100u);
+    BOOST_CHECK_EQUAL(mystring::instance_counter, 100);
+  }
+  BOOST_CHECK_EQUAL(mystring::instance_counter, 0);
+}
+
 }
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/sax.hpp>
+
+BOOST_AUTO_TEST_SUITE( sax_test )
+
+namespace {
+class Sax_TestSuite
+{
+public:
+  // records all events in a readable form
+  struct recording_handler : lastjson::sax_handler
+  {
+      std::ostringstream events;
+
+      void on_null() { events << "null "; }
+      void on_bool(bool b) { events << (b ? "true " : "false "); }
+      void on_int(int_type i) { events << "int:" << i << ' '; }
+      void on_float(float_type f) { events << "float:" << f << ' '; }
+      void on_string(char const * a, char const * b) { events << "string:" << std::string(a, b) << ' '; }
+      void on_key(char const * a, char const * b) { events << "key:" << std::string(a, b) << ' '; }
+      void on_start_array() { events << "[ "; }
+      void on_end_array() { events << "] "; }
+      void on_start_object() { events << "{ "; }
+      void on_end_object() { events << "} "; }
+  };
+
+  // only interested in some events
+  struct counting_handler : lastjson::sax_handler
+  {
+      counting_handler() : strings(0), sum(0) {}
+
+      int strings;
+      int_type sum;
+
+      void on_string(char const *, char const *) { ++strings; }
+      void on_int(int_type i) { sum += i; }
+  };
+
+  static std::string events(std::string const & txt)
+  {
+      recording_handler handler;
+      lastjson::sax_parse(txt, handler);
+      return handler.events.str();
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(events_, Sax_TestSuite)
+{
+    BOOST_CHECK_EQUAL(events("null"), "null ");
+    BOOST_CHECK_EQUAL(events(" [true, false] "), "[ true false ] ");
+    BOOST_CHECK_EQUAL(events("[1, -2.5, \"a\\tb\"]"), "[ int:1 float:-2.5 string:a\tb ] ");
+    BOOST_CHECK_EQUAL(events("{\"a\":{\"b\\u0041\":[]},\"c\":{}}"),
+                      "{ key:a { key:bA [ ] } key:c { } } ");
+    BOOST_CHECK_EQUAL(events("9223372036854775808"), "float:9.22337e+18 ");
+    BOOST_CHECK_THROW(events("[1,]"), lastjson::parser_error);
+    BOOST_CHECK_THROW(events("{\"a\"}"), lastjson::parser_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(engines_, Sax_TestSuite)
+{
+    std::string txt = "[";
+    for (int i = 0; i < 50; ++i)
+    {
+        txt += i ? ", " : "";
+        txt += "{\"n\": 1, \"s\": \"x\\\"y\", \"a\": [null, true, 0.5]}";
+    }
+    txt += "]";
+
+    recording_handler scalar;
+    char const * it = txt.data();
+    lastjson::impl::event_parser<recording_handler>(scalar).parse_value(it, txt.data() + txt.size());
+
+    recording_handler indexed;
+    lastjson::impl::parse_indexed(txt.data(), txt.data() + txt.size(), indexed);
+
+    BOOST_CHECK_EQUAL(scalar.events.str(), indexed.events.str());
+    BOOST_CHECK_EQUAL(events(txt), scalar.events.str());
+
+    counting_handler counter;
+    lastjson::sax_parse(txt.data(), txt.size(), counter);
+    BOOST_CHECK_EQUAL(counter.strings, 50);
+    BOOST_CHECK_EQUAL(counter.sum, 50);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
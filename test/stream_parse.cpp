@@ -0,0 +1,75 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+#include <lastjson/stream_parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( stream_parse_test )
+
+namespace {
+class StreamParse_TestSuite
+{
+public:
+  // parse txt from a stream in blocks of several sizes
+  static void check(std::string const & txt)
+  {
+      std::string const expected = lastjson::stringify(lastjson::parse(txt));
+      std::size_t const block_sizes[] = { 1, 2, 3, 7, 64, 65536 };
+
+      for (std::size_t i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); ++i)
+      {
+          std::istringstream in(txt);
+          lastjson::value const v = lastjson::parse_stream(in, lastjson::parse_options(), block_sizes[i]);
+          BOOST_CHECK_EQUAL(lastjson::stringify(v), expected);
+          BOOST_CHECK(in.eof());
+      }
+  }
+
+  static void failtest(std::string const & txt)
+  {
+      std::stringbuf buf(txt);
+      BOOST_CHECK_THROW(lastjson::parse_stream(buf, lastjson::parse_options(), 4), lastjson::parser_error);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(parse_, StreamParse_TestSuite)
+{
+    check("null");
+    check(" 42 \n");
+    check("\"a string \\\"with\\\" escapes \\u20ac\"");
+    check("[1,2.5,-3e2,true,false,null,\"x\",[],{}]");
+    check("{ \"a\" : [ { \"b\\u0041\" : 12 } , \"c\" ] , \"d\" : -0.25 }");
+
+    std::string big = "[";
+    for (int i = 0; i < 5000; ++i)
+    {
+        big += i ? ",{\"id\":" : "{\"id\":";
+        big += lastjson::stringify(i) + ",\"name\":\"item number " + lastjson::stringify(i) + "\"}";
+    }
+    big += "]";
+    check(big);
+
+    std::stringbuf buf("{\"k\": [true]}");
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse_stream<lastjson::value>(buf)), "{\"k\":[true]}");
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, StreamParse_TestSuite)
+{
+    failtest("");
+    failtest("  ");
+    failtest("[1, 2");
+    failtest("{\"a\": \"unterminated}");
+    failtest("[1] [2]");
+    failtest("[1 2]");
+
+    std::istringstream in("[1]");
+    in.setstate(std::ios_base::badbit);
+    BOOST_CHECK_THROW(lastjson::parse_stream(in), lastjson::parser_error);
+    BOOST_CHECK(in.fail());
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
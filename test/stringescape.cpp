@@ -957,6 +957,37 @@ BOOST_FIXTURE_TEST_CASE(escapetest_, StringRepresentation_TestSuite)
         "\"" "\\u30a8\\u69f5\\u2949\\u3bb3\\ub917\\uc2b3\\u135f\\u45a5\\u8333\\u795b\\ub672\\u446a\\ufd35\\u58c8\\u43a8\\u2149" "\"");
 }
 
+BOOST_FIXTURE_TEST_CASE(longstrings_, StringRepresentation_TestSuite)
+{
+    // escape sequences at every position around the vector sizes
+    for (std::size_t pos = 0; pos < 70; ++pos)
+    {
+        std::string const head(pos, 'a');
+        std::string const tail(40, 'b');
+        escapetest(head + tail, "\"" + head + tail + "\"");
+        escapetest(head + "\n" + tail, "\"" + head + "\\n" + tail + "\"");
+        escapetest(head + "\"" + tail + "\\", "\"" + head + "\\\"" + tail + "\\\\\"");
+
+        std::string txt = head + "\\u00e4" + tail + "\\\\" + head + "\" trailing";
+        std::string::iterator it = txt.begin();
+        std::string::iterator a, b;
+        lastjson::impl::unescape_string_inplace(it, txt.end(), a, b);
+        BOOST_CHECK_EQUAL(std::string(a, b), head + "\xc3\xa4" + tail + "\\" + head);
+        BOOST_CHECK_EQUAL(std::string(it, txt.end()), " trailing");
+
+        std::string txt2 = head + "\\t" + tail + "\"";
+        char * p = &txt2[0];
+        char * pa;
+        char * pb;
+        lastjson::impl::unescape_string_inplace(p, p + txt2.size(), pa, pb);
+        BOOST_CHECK_EQUAL(std::string(pa, pb), head + "\t" + tail);
+        BOOST_CHECK(p == &txt2[0] + txt2.size());
+    }
+
+    BOOST_CHECK_THROW(lastjson::parse("\"" + std::string(100, 'a')), lastjson::parser_error);
+    BOOST_CHECK_THROW(lastjson::parse("\"" + std::string(100, 'a') + "\\"), lastjson::parser_error);
+}
+
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,180 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( structural_test )
+
+namespace {
+class Structural_TestSuite
+{
+public:
+  // Straightforward byte-by-byte definition of the structural index. Like
+  // the vectorised version, it lets a backslash escape the following quote
+  // even outside of strings, where it is a syntax error anyway.
+  static std::vector<uint32_t> reference_index(std::string const & txt)
+  {
+      std::vector<uint32_t> index;
+      bool in_string = false;
+      bool in_scalar = false;
+      bool escaped = false;
+
+      for (size_t i = 0; i < txt.size(); ++i)
+      {
+          char const c = txt[i];
+          bool const quote = (c == '"' && !escaped);
+          escaped = (c == '\\' && !escaped);
+
+          if (in_string)
+          {
+              if (quote)
+              {
+                  index.push_back(i);
+                  in_string = false;
+              }
+              continue;
+          }
+
+          bool const ws = (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+          bool const op = (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',');
+          if (quote)
+          {
+              index.push_back(i);
+              in_string = true;
+              in_scalar = false;
+          }
+          else if (op)
+          {
+              index.push_back(i);
+              in_scalar = false;
+          }
+          else if (ws)
+          {
+              in_scalar = false;
+          }
+          else if (!in_scalar)
+          {
+              index.push_back(i);
+              in_scalar = true;
+          }
+      }
+
+      return index;
+  }
+
+  static void indextest(std::string const & txt)
+  {
+      std::vector<uint32_t> const expected = reference_index(txt);
+
+      for (int level = lastjson::impl::SIMD_NONE; level <= lastjson::impl::available_simd_level(); ++level)
+      {
+          std::vector<uint32_t> index;
+          lastjson::impl::build_structural_index(txt.data(), txt.size(), index,
+                                                 lastjson::impl::simd_level(level));
+          BOOST_CHECK(index == expected);
+      }
+  }
+
+  static std::string parse_scalar(std::string const & txt)
+  {
+      char const * it = txt.data();
+      char const * const end = it + txt.size();
+      lastjson::impl::skipws(it, end);
+      lastjson::value const val = lastjson::impl::parse_fragment<lastjson::value>(it, end);
+      lastjson::impl::skipws(it, end);
+      BOOST_CHECK(it == end);
+      return lastjson::stringify(val);
+  }
+
+  static void enginetest(std::string const & txt)
+  {
+      std::string const expected = parse_scalar(txt);
+
+      for (int level = lastjson::impl::SIMD_NONE; level <= lastjson::impl::available_simd_level(); ++level)
+      {
+          lastjson::value const val = lastjson::impl::parse_indexed<lastjson::value>(
+              txt.data(), txt.data() + txt.size(), lastjson::impl::simd_level(level));
+          BOOST_CHECK_EQUAL(lastjson::stringify(val), expected);
+      }
+  }
+
+  static void failtest(std::string const & txt)
+  {
+      BOOST_CHECK_THROW(lastjson::impl::parse_indexed<lastjson::value>(txt.data(), txt.data() + txt.size()),
+                        lastjson::parser_error);
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(index_, Structural_TestSuite)
+{
+    indextest("");
+    indextest("null");
+    indextest(" [1, 2.5e3 ,true,{\"a\":\"b\"}] ");
+    indextest("\"escaped \\\" quote, and \\\\\" : 1");
+    indextest(std::string(63, ' ') + "\"\\\\\"" + std::string(70, 'x'));
+    indextest(std::string(62, ' ') + "\"\\\"" + std::string(70, ' ') + "\"");
+    indextest("\"" + std::string(200, '\\') + "\" 123");
+
+    // random soup of significant characters, crossing many block boundaries
+    char const alphabet[] = "\"\\{}[]:, \nab1";
+    std::srand(42);
+    for (int n = 0; n < 500; ++n)
+    {
+        std::string txt(std::rand() % 300, ' ');
+        for (size_t i = 0; i < txt.size(); ++i)
+        {
+            txt[i] = alphabet[std::rand() % (sizeof(alphabet) - 1)];
+        }
+        indextest(txt);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(engine_, Structural_TestSuite)
+{
+    enginetest("null");
+    enginetest("true");
+    enginetest("-12");
+    enginetest("\"\"");
+    enginetest("\"foo\\nbar\\u20ac\"");
+    enginetest("[]");
+    enginetest("{}");
+    enginetest(" [ 1 , -2.5e3 , true , false , null , \"x\" , [ ] , { } ] ");
+    enginetest("{\"a\":{\"b\":[1,{\"c\":\"\\\"d\\\"\"}]},\"e\\u0041\":\"f\"}");
+
+    std::string big = "[";
+    for (int i = 0; i < 200; ++i)
+    {
+        if (i)
+        {
+            big += ",\n  ";
+        }
+        big += "{\"id\": 12345, \"name\": \"track \\\"" + std::string(i % 70, 'x')
+            + "\", \"score\": 0.125, \"tags\": [\"a\", \"b\"], \"ok\": true}";
+    }
+    big += "]";
+    enginetest(big);
+    BOOST_CHECK_EQUAL(lastjson::stringify(lastjson::parse(big)), parse_scalar(big));
+}
+
+BOOST_FIXTURE_TEST_CASE(engine_errors_, Structural_TestSuite)
+{
+    failtest("");
+    failtest("[");
+    failtest("[1,");
+    failtest("[1 2]");
+    failtest("{\"a\" 1}");
+    failtest("{\"a\":1,}");
+    failtest("{1:1}");
+    failtest("\"unterminated");
+    failtest("tru");
+    failtest("truex");
+    failtest("true false");
+    failtest("\"a\"b");
+    failtest("]");
+    failtest("[1]]");
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
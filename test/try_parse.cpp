@@ -0,0 +1,122 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <lastjson/stringify.hpp>
+#include <lastjson/parse.hpp>
+
+BOOST_AUTO_TEST_SUITE( try_parse_test )
+
+namespace {
+class TryParse_TestSuite
+{
+public:
+  struct error_case
+  {
+      char const * json;
+      lastjson::parse_error_code code;
+      std::size_t offset;
+  };
+
+  static void check(std::string const & json, lastjson::parse_error_code code, std::size_t offset,
+                    lastjson::parse_options const & options = lastjson::parse_options())
+  {
+      BOOST_TEST_CONTEXT("json: " << json)
+      {
+          lastjson::value v("untouched");
+          lastjson::parse_result const result = lastjson::try_parse(json, v, options);
+          BOOST_CHECK(!result.ok());
+          BOOST_CHECK_EQUAL(result.code, code);
+          BOOST_CHECK_EQUAL(result.offset, offset);
+          BOOST_CHECK_EQUAL(v.get_string(), "untouched");
+
+          // parse() reports the same error by exception
+          std::string message;
+          try
+          {
+              lastjson::parse(json, options);
+          }
+          catch (lastjson::parser_error const & e)
+          {
+              message = e.what();
+          }
+          BOOST_CHECK_EQUAL(message, result.message());
+      }
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(success_, TryParse_TestSuite)
+{
+    lastjson::value v;
+    lastjson::parse_result const result = lastjson::try_parse("{\"a\": [1, \"x\"]} ", v);
+    BOOST_CHECK(result.ok());
+    BOOST_CHECK_EQUAL(result.code, lastjson::PARSE_OK);
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "{\"a\":[1,\"x\"]}");
+
+    std::string const txt = "[true, null]";
+    BOOST_CHECK(lastjson::try_parse(txt.data(), txt.data() + txt.size(), v).ok());
+    BOOST_CHECK_EQUAL(lastjson::stringify(v), "[true,null]");
+}
+
+BOOST_FIXTURE_TEST_CASE(errors_, TryParse_TestSuite)
+{
+    error_case const cases[] =
+    {
+        { "", lastjson::PARSE_PREMATURE_END, 0 },
+        { "   ", lastjson::PARSE_PREMATURE_END, 3 },
+        { "[", lastjson::PARSE_PREMATURE_END_IN_ARRAY, 1 },
+        { "[1, 2", lastjson::PARSE_PREMATURE_END_IN_ARRAY, 5 },
+        { "{\"a\": 1", lastjson::PARSE_PREMATURE_END_IN_OBJECT, 7 },
+        { "\"abc", lastjson::PARSE_PREMATURE_END_IN_STRING, 4 },
+        { "1e", lastjson::PARSE_PREMATURE_END_IN_FLOAT, 2 },
+        { "\"\\u12", lastjson::PARSE_PREMATURE_END_IN_ESCAPE, 5 },
+        { "nul", lastjson::PARSE_INVALID_DATA, 0 },
+        { "]", lastjson::PARSE_INVALID_DATA, 0 },
+        { "[1 2]", lastjson::PARSE_INVALID_ARRAY, 3 },
+        { "{\"a\" 1}", lastjson::PARSE_INVALID_OBJECT, 5 },
+        { "{1: 2}", lastjson::PARSE_INVALID_OBJECT, 1 },
+        { "\"\\x\"", lastjson::PARSE_INVALID_ESCAPE, 3 },
+        { "\"\\u12g4\"", lastjson::PARSE_INVALID_UNICODE_ESCAPE, 5 },
+        { "\"\\ud800\"", lastjson::PARSE_INVALID_SURROGATE, 7 },
+        { "1e999", lastjson::PARSE_NUMBER_OUT_OF_RANGE, 5 },
+        { "1 2", lastjson::PARSE_TRAILING_DATA, 2 },
+        { "[1]]", lastjson::PARSE_TRAILING_DATA, 3 },
+    };
+
+    for (std::size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        check(cases[i].json, cases[i].code, cases[i].offset);
+    }
+
+    lastjson::parse_options options;
+    options.max_depth = 1;
+    check("[[1]]", lastjson::PARSE_NESTED_TOO_DEEPLY, 1, options);
+}
+
+BOOST_FIXTURE_TEST_CASE(indexed_, TryParse_TestSuite)
+{
+    // long enough for the structural index engine
+    std::string prefix = "[";
+    for (int i = 0; i < 100; ++i)
+    {
+        prefix += "\"x\", ";
+    }
+
+    check(prefix + "tru, 1]", lastjson::PARSE_INVALID_DATA, prefix.size());
+    check(prefix + "1 2]", lastjson::PARSE_INVALID_ARRAY, prefix.size() + 2);
+    check(prefix + "{\"a\" 1}]", lastjson::PARSE_INVALID_OBJECT, prefix.size() + 5);
+    check(prefix + "\"\\q\"]", lastjson::PARSE_INVALID_ESCAPE, prefix.size() + 3);
+    check(prefix + "1e999]", lastjson::PARSE_NUMBER_OUT_OF_RANGE, prefix.size() + 5);
+    check(prefix + "1", lastjson::PARSE_PREMATURE_END_IN_ARRAY, prefix.size() + 1);
+    check(prefix + "1] 2", lastjson::PARSE_TRAILING_DATA, prefix.size() + 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(messages_, TryParse_TestSuite)
+{
+    BOOST_CHECK_EQUAL(std::string(lastjson::parse_error_message(lastjson::PARSE_OK)), "no error");
+    BOOST_CHECK_EQUAL(std::string(lastjson::parse_result(lastjson::PARSE_NESTED_TOO_DEEPLY, 3).message()),
+                      "json data nested too deeply");
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()
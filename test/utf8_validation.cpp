@@ -0,0 +1,94 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include <lastjson/parse.hpp>
+#include <lastjson/lazy_parse.hpp>
+#include <lastjson/utf8_validation.hpp>
+
+BOOST_AUTO_TEST_SUITE( utf8_validation_test )
+
+namespace {
+class Utf8Validation_TestSuite
+{
+public:
+  // the offset of the first invalid sequence, by every available instruction set
+  static std::size_t check(std::string const & txt)
+  {
+      char const * const begin = txt.data();
+      char const * const end = begin + txt.size();
+      std::size_t const offset = lastjson::impl::validate_utf8(begin, end, lastjson::impl::SIMD_NONE) - begin;
+
+      for (int level = lastjson::impl::SIMD_SSE2; level <= lastjson::impl::available_simd_level(); ++level)
+      {
+          BOOST_CHECK_EQUAL(std::size_t(lastjson::impl::validate_utf8(begin, end, lastjson::impl::simd_level(level)) - begin),
+                            offset);
+      }
+
+      return offset;
+  }
+};
+
+BOOST_FIXTURE_TEST_CASE(sequences_, Utf8Validation_TestSuite)
+{
+    BOOST_CHECK_EQUAL(check(""), 0u);
+    BOOST_CHECK_EQUAL(check("plain ascii"), 11u);
+    BOOST_CHECK_EQUAL(check("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x8e\xb5"), 14u);
+    BOOST_CHECK_EQUAL(check("\xef\xbf\xbf\xf4\x8f\xbf\xbf"), 7u);
+
+    BOOST_CHECK_EQUAL(check("ab\x80"), 2u);                  // lone continuation
+    BOOST_CHECK_EQUAL(check("ab\xc3"), 2u);                  // truncated
+    BOOST_CHECK_EQUAL(check("ab\xc3z"), 2u);
+    BOOST_CHECK_EQUAL(check("ab\xe2\x82z"), 2u);
+    BOOST_CHECK_EQUAL(check("ab\xc0\xaf"), 2u);              // overlong
+    BOOST_CHECK_EQUAL(check("ab\xe0\x9f\xbf"), 2u);
+    BOOST_CHECK_EQUAL(check("ab\xf0\x8f\xbf\xbf"), 2u);
+    BOOST_CHECK_EQUAL(check("ab\xed\xa0\x80"), 2u);          // surrogate
+    BOOST_CHECK_EQUAL(check("ab\xf4\x90\x80\x80"), 2u);      // above U+10FFFF
+    BOOST_CHECK_EQUAL(check("ab\xf8\x88\x80\x80\x80"), 2u);
+    BOOST_CHECK_EQUAL(check("ab\xc3\xa9\xa9"), 4u);          // too long
+
+    // errors at every position around the 16 and 32 byte block boundaries
+    for (std::size_t pos = 0; pos < 70; ++pos)
+    {
+        std::string txt(pos, 'x');
+        txt += "\xe2\x82\xac";
+        BOOST_CHECK_EQUAL(check(txt + "\xe2\x82\xac" + std::string(40, 'y')), txt.size() + 43);
+        BOOST_CHECK_EQUAL(check(txt + "\xe2\x82" + std::string(40, 'y')), txt.size());
+        BOOST_CHECK_EQUAL(check(txt + "\xf0\x9f\x8e"), txt.size());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(parse_, Utf8Validation_TestSuite)
+{
+    lastjson::parse_options options;
+    options.validate_utf8 = true;
+
+    std::string const bad = "[\"ab\xc3(\"]";
+    lastjson::value v;
+    BOOST_CHECK(lastjson::try_parse(bad, v).ok());
+
+    lastjson::parse_result const result = lastjson::try_parse(bad, v, options);
+    BOOST_CHECK_EQUAL(result.code, lastjson::PARSE_INVALID_UTF8);
+    BOOST_CHECK_EQUAL(result.offset, 4u);
+    BOOST_CHECK_THROW(lastjson::parse(bad, options), lastjson::parser_error);
+
+    std::string const good = "{\"caf\xc3\xa9\": \"\xe2\x82\xac\\u00e9\"}";
+    BOOST_CHECK_EQUAL(lastjson::parse(good, options)["caf\xc3\xa9"].get_string(), "\xe2\x82\xac\xc3\xa9");
+
+    // long enough for the structural index engine
+    std::string doc = "[";
+    for (int i = 0; i < 100; ++i)
+    {
+        doc += "\"\xc3\xa9\", ";
+    }
+    doc += "\"\xed\xa0\x80\"]";
+    BOOST_CHECK_EQUAL(lastjson::try_parse(doc, v, options).offset, doc.size() - 5);
+
+    lastjson::lazy_options lazy;
+    lazy.parse.validate_utf8 = true;
+    BOOST_CHECK_THROW(lastjson::parse_lazy(doc, lazy), lastjson::parser_error);
+}
+
+}
+BOOST_AUTO_TEST_SUITE_END()